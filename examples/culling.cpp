@@ -0,0 +1,116 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+// runs the gpu culling pass on a grid of spheres and checks it against the cpu:
+// frustum culling first, then occlusion against a synthetic depth buffer
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <gltoolbox/gltoolbox.h>
+#include <gltoolbox/utils/gpuculler.h>
+#include <GLFW/glfw3.h>
+
+static void glfw_error_callback(int error, const char *description)
+{
+  fprintf(stderr, "Glfw Error %d: %s\n", error, description);
+}
+
+int main()
+{
+  glfwSetErrorCallback(glfw_error_callback);
+  if (!glfwInit())
+    return 1;
+
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+  glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+  GLFWwindow *window = glfwCreateWindow(64, 64, "gltoolbox culling", nullptr, nullptr);
+  if (window == nullptr)
+    return 1;
+
+  glfwMakeContextCurrent(window);
+  gltoolbox::GL::initilize(glfwGetProcAddress);
+
+  std::cout << "OpenGL renderer: " << glGetString(GL_RENDERER) << std::endl;
+
+  //spheres on a grid spanning [-3, 3]^2, the identity matrix keeps [-1, 1]^2
+  const int N = 64;
+  const float radius = 0.02f;
+  std::vector<gltoolbox::CullObject> objects;
+  GLuint inFrustum = 0, unoccluded = 0;
+  for (int j = 0; j < N; ++j)
+    for (int i = 0; i < N; ++i)
+    {
+      float x = -3.f + 6.f * i / (N - 1);
+      float y = -3.f + 6.f * j / (N - 1);
+      GLuint id = GLuint(objects.size());
+      objects.push_back({{x, y, 0.f}, radius, 6, 0, 0, id});
+
+      bool visible = std::abs(x) <= 1.f + radius && std::abs(y) <= 1.f + radius;
+      inFrustum += visible;
+      //the occluder covers x > 0 in front of the spheres
+      unoccluded += visible && x - radius < 0.f;
+    }
+
+  gltoolbox::GpuCuller culler(true);
+  culler.set_objects(objects);
+
+  const float identity[16] = {1.f, 0.f, 0.f, 0.f,
+                              0.f, 1.f, 0.f, 0.f,
+                              0.f, 0.f, 1.f, 0.f,
+                              0.f, 0.f, 0.f, 1.f};
+  culler.cull(identity);
+  GLuint frustum = culler.read_draw_count();
+
+  //depth buffer with the right half closer than the spheres (depth 0.5)
+  const GLsizei W = 256, H = 256;
+  std::vector<float> depth(W * H);
+  for (GLsizei y = 0; y < H; ++y)
+    for (GLsizei x = 0; x < W; ++x)
+      depth[y * W + x] = (x < W / 2) ? 1.f : 0.25f;
+
+  gltoolbox::Texture depthTex(GL_TEXTURE_2D, GL_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+  glTextureStorage2D(GLuint(depthTex.id()), 1, GL_R32F, W, H);
+  glTextureSubImage2D(GLuint(depthTex.id()), 0, 0, 0, W, H, GL_RED, GL_FLOAT, depth.data());
+
+  culler.build_depth_pyramid(depthTex, W, H);
+  culler.set_occlusion(true);
+  culler.cull(identity);
+  GLuint occlusion = culler.read_draw_count();
+
+  std::printf("objects %zu\n", objects.size());
+  std::printf("frustum   : %u visible (expected %u)\n", frustum, inFrustum);
+  std::printf("occlusion : %u visible (expected %u)\n", occlusion, unoccluded);
+
+  glfwDestroyWindow(window);
+  glfwTerminate();
+
+  return (frustum == inFrustum && occlusion == unoccluded) ? 0 : 1;
+}
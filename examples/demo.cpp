@@ -94,6 +94,7 @@ int main(int argc, char **argv)
     double t0 = glfwGetTime();
     txt.draw(text, 0, 100, 64);
     txt.draw("{ this works }", width / 2, 200, 128);
+    txt.end_frame();
     double t1 = glfwGetTime();
 
     double dt = t1 - t0;
@@ -32,6 +32,8 @@ std::unique_ptr<Shape2D::PolygonRenderer> Shape2D::mPoly;
 
 bool Shape2D::mIsInit = false;
 
+ProgramCache *Shape2D::mCache = nullptr;
+
 void Shape2D::color(float r, float g, float b, float a)
 {
   if (!mIsInit)
@@ -64,10 +66,16 @@ void Shape2D::draw_quad(float x, float y, float w, float h, float theta)
   mPoly->render(4, x - w * 0.5 * 0.41421356237, y - h * 0.5 * 0.41421356237, w * 1.41421356237, h * 1.41421356237, theta, -M_PI_4);
 }
 
+void Shape2D::end_frame()
+{
+  if (mIsInit)
+    mPoly->end_frame();
+}
+
 void Shape2D::init()
 {
   mPoly.reset(new PolygonRenderer());
-  mPoly->init(360);
+  mPoly->init(360, mCache);
   mIsInit = true;
 }
 
@@ -94,7 +102,7 @@ void Shape2D::PolygonRenderer::zvalue(float z)
   mZindex = z;
 }
 
-void Shape2D::PolygonRenderer::init(int npts)
+void Shape2D::PolygonRenderer::init(int npts, ProgramCache *cache)
 {
   mNumSamples = npts;
   mSides = npts;
@@ -125,9 +133,14 @@ void Shape2D::PolygonRenderer::init(int npts)
                      "}";
 
   //setup program
-  mPrg.attach_shader(vert, GL_VERTEX_SHADER);
-  mPrg.attach_shader(frag, GL_FRAGMENT_SHADER);
-  mPrg.link();
+  if (cache)
+    mPrg.link(*cache, {{GL_VERTEX_SHADER, vert}, {GL_FRAGMENT_SHADER, frag}});
+  else
+  {
+    mPrg.attach_shader(vert, GL_VERTEX_SHADER);
+    mPrg.attach_shader(frag, GL_FRAGMENT_SHADER);
+    mPrg.link();
+  }
 
   mPrg.add_attribute("vert");
 
@@ -141,18 +154,10 @@ void Shape2D::PolygonRenderer::init(int npts)
   mPrg.add_uniform<float>("zindex", &mZindex);
   mPrg.add_uniform<std::array<float, 4>>("rgba", &mColor);
 
-  //init coord vector
-  mCoords.resize((npts + 2) * 2);
-  float dtheta = 2 * M_PI / float(npts);
-  mCoords[0] = 0;
-  mCoords[1] = 0;
-  for (int i = 0; i < npts; ++i)
-  {
-    mCoords[2 * (i + 1) + 0] = sin(i * dtheta);
-    mCoords[2 * (i + 1) + 1] = cos(i * dtheta);
-  }
-  mCoords[2 * (npts + 1) + 0] = sin(0);
-  mCoords[2 * (npts + 1) + 1] = cos(0);
+  //init coord buffer, vertices are written straight into mapped memory,
+  //each region holds several polygons so that changing the side count does not wait on the gpu
+  mCoords = std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, 2 * sizeof(float), 16 * (npts + 2));
+  update_vertices();
 
   //init index vector
   mIndices.resize(npts + 2, 0);
@@ -161,7 +166,8 @@ void Shape2D::PolygonRenderer::init(int npts)
 
   //setup vao
   mVao.set_index_buffer<unsigned short>(GL_TRIANGLE_FAN, mIndices.data(), mIndices.size(), GL_STATIC_DRAW);
-  mVao.add_attribute<float>("vert", mCoords.data(), mCoords.size(), 2, GL_FLOAT, 0, 0, GL_DYNAMIC_DRAW);
+  mVao.add_attribute("vert", mCoords, mCoords->capacity() * mCoords->num_regions(), 2, GL_FLOAT, 0, 0);
+  mVao.enable_attributes(mPrg);
 }
 
 void Shape2D::PolygonRenderer::render(int n, float x, float y, float w, float h, float theta1, float theta2)
@@ -204,24 +210,45 @@ void Shape2D::PolygonRenderer::render(int n, float x, float y, float w, float h,
   mPrg.enable_uniform("rgba");
 
   mVao.bind();
-  mVao.enable_attributes(mPrg.attributes());
-  mVao.draw_elements(0, mSides + 2);
-  mVao.disable_attributes(mPrg.attributes());
+  mVao.draw_elements_base_vertex(0, mSides + 2, mBaseVertex);
   mVao.unbind();
 
   mPrg.unuse();
 }
 
+void Shape2D::PolygonRenderer::end_frame()
+{
+  if (mCoords->region_count() == 0)
+    return;
+
+  //the current polygon lives in the fenced region, write it again in the next one
+  mCoords->next_region();
+  update_vertices();
+}
+
 void Shape2D::PolygonRenderer::update_vertices()
 {
+  //append after the polygons already drawn from the current region, pending draws keep reading them
+  mCoords->region_ptr();
+  GLsizei first = mCoords->reserve(mSides + 2);
+  if (first < 0)
+  {
+    mCoords->next_region();
+    mCoords->region_ptr();
+    first = mCoords->reserve(mSides + 2);
+  }
+  float *coords = mCoords->element_ptr<float>(first);
+
   float dtheta = 2 * M_PI / float(mSides);
+  coords[0] = 0;
+  coords[1] = 0;
   for (int i = 0; i < mSides; ++i)
   {
-    mCoords[2 * (i + 1) + 0] = sin(i * dtheta);
-    mCoords[2 * (i + 1) + 1] = cos(i * dtheta);
+    coords[2 * (i + 1) + 0] = sin(i * dtheta);
+    coords[2 * (i + 1) + 1] = cos(i * dtheta);
   }
-  mCoords[2 * (mSides + 1) + 0] = sin(0);
-  mCoords[2 * (mSides + 1) + 1] = cos(0);
+  coords[2 * (mSides + 1) + 0] = sin(0);
+  coords[2 * (mSides + 1) + 1] = cos(0);
 
-  // mVao.attribute_buffer("vert")->update(0, 2 * (mSides + 2));
+  mBaseVertex = first;
 }
\ No newline at end of file
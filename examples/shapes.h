@@ -28,6 +28,7 @@
 #define __GLTOOLBOX_SHAPES_H_
 
 #include <gltoolbox/program.h>
+#include <gltoolbox/streambuffer.h>
 #include <gltoolbox/vertexarray.h>
 
 namespace gltoolbox
@@ -44,9 +45,15 @@ namespace gltoolbox
 
     static void draw_quad(float x, float y, float w, float h, float theta = 0.f);
 
+    //release the vertices written this frame to the gpu, call once per frame after the last draw
+    static void end_frame();
+
   public:
     static void init();
 
+    //programs are loaded from / stored into cache when set, call before the first draw
+    static void set_program_cache(ProgramCache *cache) { mCache = cache; }
+
   protected:
     class PolygonRenderer
     {
@@ -57,8 +64,9 @@ namespace gltoolbox
       void color(float r, float g, float b, float a = 1.f);
       void zvalue(float z);
 
-      void init(int npts);
+      void init(int npts, ProgramCache *cache = nullptr);
       void render(int n, float x, float y, float w, float h, float theta1 = 0.f, float theta2 = 0.f);
+      void end_frame();
 
     protected:
       void update_vertices();
@@ -70,7 +78,8 @@ namespace gltoolbox
       std::array<float, 4> mColor;
 
       float mZindex;
-      std::vector<float> mCoords;
+      GLint mBaseVertex;
+      std::shared_ptr<StreamBuffer> mCoords;
       std::vector<unsigned short> mIndices;
 
       Program mPrg;
@@ -80,6 +89,7 @@ namespace gltoolbox
   protected:
     static std::unique_ptr<PolygonRenderer> mPoly;
     static bool mIsInit;
+    static ProgramCache *mCache;
   };
 
 } // namespace gltoolbox
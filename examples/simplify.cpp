@@ -0,0 +1,105 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+// simplification benchmark: error and triangle count of a bumpy sphere
+// simplified to several target ratios, plus the lod chain built from it.
+// usage: simplify [rings] (default 200, about 160k triangles)
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include <gltoolbox/utils/simplifier.h>
+
+int main(int argc, char **argv)
+{
+  const int rings = (argc > 1) ? std::max(std::atoi(argv[1]), 4) : 200;
+  const int segments = 2 * rings;
+  const float pi = 3.14159265358979f;
+
+  //welded latitude/longitude sphere, one vertex per pole and no seam
+  std::vector<float> positions;
+  auto add_vertex = [&](float theta, float phi) {
+    float r = 1.f + 0.05f * std::sin(8.f * theta) * std::sin(8.f * phi);
+    positions.push_back(r * std::sin(theta) * std::cos(phi));
+    positions.push_back(r * std::sin(theta) * std::sin(phi));
+    positions.push_back(r * std::cos(theta));
+  };
+
+  add_vertex(0.f, 0.f);
+  for (int i = 1; i < rings; ++i)
+    for (int j = 0; j < segments; ++j)
+      add_vertex(pi * i / rings, 2.f * pi * j / segments);
+  add_vertex(pi, 0.f);
+
+  const GLuint south = GLuint(positions.size() / 3 - 1);
+  auto vertex = [&](int i, int j) { return GLuint(1 + (i - 1) * segments + (j % segments)); };
+
+  std::vector<GLuint> indices;
+  for (int j = 0; j < segments; ++j)
+  {
+    indices.insert(indices.end(), {0, vertex(1, j), vertex(1, j + 1)});
+    indices.insert(indices.end(), {south, vertex(rings - 1, j + 1), vertex(rings - 1, j)});
+  }
+  for (int i = 1; i < rings - 1; ++i)
+    for (int j = 0; j < segments; ++j)
+    {
+      indices.insert(indices.end(), {vertex(i, j), vertex(i + 1, j), vertex(i + 1, j + 1)});
+      indices.insert(indices.end(), {vertex(i, j), vertex(i + 1, j + 1), vertex(i, j + 1)});
+    }
+
+  const GLsizei numvertices = GLsizei(positions.size() / 3);
+  const GLsizei count = GLsizei(indices.size());
+  std::printf("bumpy sphere: %d vertices, %d triangles (error in object units, radius 1)\n\n", numvertices, count / 3);
+
+  typedef std::chrono::steady_clock Clock;
+
+  std::printf("target   triangles     error      time\n");
+  for (float ratio : {0.5f, 0.25f, 0.1f, 0.02f})
+  {
+    float error = 0.f;
+    auto begin = Clock::now();
+    std::vector<GLuint> result = gltoolbox::simplify(indices.data(), count, positions.data(), numvertices,
+                                                     3 * sizeof(float), GLsizei(count * ratio) / 3 * 3, 1e30f, &error);
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+    std::printf("%5.0f%%  %10zu  %9.5f  %7.1f ms\n", 100.f * ratio, result.size() / 3, error, ms);
+  }
+
+  std::vector<GLuint> lodindices;
+  auto begin = Clock::now();
+  std::vector<gltoolbox::MeshLod> lods = gltoolbox::build_lods(indices, positions.data(), numvertices,
+                                                               3 * sizeof(float), lodindices);
+  double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+  std::printf("\nlod chain (%.1f ms)\nlod   triangles     error\n", ms);
+  for (size_t l = 0; l < lods.size(); ++l)
+    std::printf("%3zu  %10d  %9.5f\n", l, lods[l].count / 3, lods[l].error);
+
+  return 0;
+}
@@ -28,6 +28,9 @@
 #define __GLTOOLBOX_BUFFER_H__
 
 #include "gl.h"
+#include "readback.h"
+
+#include <atomic>
 #include <vector>
 
 namespace gltoolbox
@@ -50,6 +53,10 @@ namespace gltoolbox
     //=====================================================
 
     inline GLuint id() const { return mId; }
+
+    //changes every time a new buffer object replaces the store, drivers reuse deleted names
+    //so the id alone does not tell whether a vertex array still points to the current store
+    inline size_t generation() const { return mGeneration; }
     inline bool is_valid() const { return (glIsBuffer(mId) == GL_TRUE); }
 
     inline GLenum target() const { return mTarget; }
@@ -57,8 +64,11 @@ namespace gltoolbox
     inline GLenum usage() const { return mUsage; }
     inline void set_usage(GLenum usage) { mUsage = usage; }
 
+    inline bool is_immutable() const { return mImmutable; }
+    inline BufferStorageMask storage_flags() const { return mStorageFlags; }
+
     inline GLsizei element_size() const { return mElementSize; }
-    inline GLsizei buffer_size() const { return get_parameter(GL_BUFFER_SIZE); }
+    inline GLsizei buffer_size() const { return GLsizei(mSize); } // cached, no gpu query
 
     //=====================================================
     // Buffer operations
@@ -71,14 +81,29 @@ namespace gltoolbox
     // Buffer content
     //======================================================
 
+    //allocate immutable storage for count elements, the size can no longer change afterwards.
+    //flags: GL_DYNAMIC_STORAGE_BIT (needed by upload), GL_MAP_{READ|WRITE|PERSISTENT|COHERENT}_BIT, GL_CLIENT_STORAGE_BIT
+    void allocate_storage(GLsizei count, BufferStorageMask flags = GL_DYNAMIC_STORAGE_BIT, void *ptr = nullptr);
+
     //send data from CPU memory to GPU memory
-    void upload(void *ptr, GLsizei count) const;
+    //the store is only re-specified when the data does not fit in the current one
+    void upload(void *ptr, GLsizei count);
     void upload(void *ptr, GLsizei offset, GLsizei count) const;
 
     //send data from GPU memory to CPU memory
     void download(void *ptr, GLsizei size) const;
     void download(void *ptr, GLsizei offset, GLsizei size) const;
 
+    //map count elements starting at offset, the pointer can be handed to worker threads.
+    //with GL_MAP_FLUSH_EXPLICIT_BIT written ranges must be flushed before unmap or draw
+    void *map(GLsizei offset, GLsizei count,
+              MapBufferAccessMask access = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT | GL_MAP_UNSYNCHRONIZED_BIT) const;
+    void flush_mapped(GLsizei offset, GLsizei count) const; // offset relative to the start of the mapping
+    bool unmap() const;
+
+    //start a copy from GPU memory to CPU memory without waiting for it
+    Readback download_async(GLintptr offset, GLsizeiptr size) const;
+
   protected:
     void create();
     void destroy();
@@ -88,10 +113,15 @@ namespace gltoolbox
   protected:
     GLuint mId;
     bool mOwned;
+    size_t mGeneration;
 
     GLenum mUsage;
     GLenum mTarget;
     GLsizei mElementSize;
+
+    GLsizeiptr mSize; //allocated bytes
+    bool mImmutable;
+    BufferStorageMask mStorageFlags;
   };
 }
 
@@ -0,0 +1,144 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_BUFFERARENA_H__
+#define __GLTOOLBOX_BUFFERARENA_H__
+
+#include "buffer.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace gltoolbox
+{
+  class BufferArena; //forward declaration of arena class
+
+  // handle on a range of bytes carved out of a BufferArena block.
+  // handles are cheap to copy and stay valid when the arena is defragmented.
+  class BufferRange
+  {
+    friend class BufferArena;
+
+  protected:
+    struct Allocation
+    {
+      std::shared_ptr<Buffer> buffer;
+      GLintptr offset;
+      GLsizeiptr size;
+      GLuint block;
+    };
+
+  public:
+    BufferRange() {}
+
+    inline bool is_valid() const { return mAlloc && mAlloc->buffer; }
+
+    inline const std::shared_ptr<Buffer> &buffer() const { return mAlloc->buffer; }
+    inline GLintptr offset() const { return mAlloc->offset; }
+    inline GLsizeiptr size() const { return mAlloc->size; }
+
+    //offset and size are in bytes, relative to the start of the range
+    void upload(const void *ptr, GLsizeiptr size, GLintptr offset = 0) const;
+    void download(void *ptr, GLsizeiptr size, GLintptr offset = 0) const;
+
+  protected:
+    std::shared_ptr<Allocation> mAlloc;
+  };
+
+  // sub-allocator packing many small logical buffers into a few large immutable ones.
+  // free ranges are kept coalesced and allocation picks the best fit.
+  class BufferArena
+  {
+  public:
+    struct Statistics
+    {
+      GLsizeiptr reserved; // bytes owned by the arena
+      GLsizeiptr used;     // bytes handed out
+      GLsizeiptr free;     // bytes available
+      GLsizeiptr largest;  // largest contiguous free range
+      size_t numBlocks;
+      size_t numRanges;
+      size_t numFreeRanges;
+      float fragmentation; // 0 when all free memory is contiguous, tends to 1 when scattered
+    };
+
+  protected:
+    struct Block
+    {
+      std::shared_ptr<Buffer> buffer;
+      GLsizeiptr size;
+
+      std::map<GLintptr, GLsizeiptr> freeRanges;         // offset -> size
+      std::multimap<GLsizeiptr, GLintptr> freeBySize;    // size -> offset
+      std::map<GLintptr, std::shared_ptr<BufferRange::Allocation>> usedRanges;
+    };
+
+  public:
+    BufferArena(GLenum target, GLsizeiptr blocksize = 1 << 24, GLsizeiptr alignment = 256);
+
+    BufferArena(const BufferArena &other) = delete;
+
+    virtual ~BufferArena();
+
+    BufferArena &operator=(const BufferArena &other) = delete;
+
+    inline GLenum target() const { return mTarget; }
+    inline GLsizeiptr block_size() const { return mBlockSize; }
+    inline GLsizeiptr alignment() const { return mAlignment; }
+    inline size_t num_blocks() const { return mBlocks.size(); }
+
+    //=====================================================
+    // Allocation
+    //=====================================================
+
+    BufferRange allocate(GLsizeiptr size);
+    BufferRange allocate(const void *ptr, GLsizeiptr size);
+
+    void free(BufferRange &range);
+
+    //pack all ranges at the start of their block and release empty blocks.
+    //content is copied on the gpu, existing handles are updated in place.
+    void defragment();
+
+    Statistics statistics() const;
+
+  protected:
+    GLuint add_block(GLsizeiptr size);
+
+    void insert_free(Block &block, GLintptr offset, GLsizeiptr size);
+    void erase_free(Block &block, GLintptr offset, GLsizeiptr size);
+
+  protected:
+    GLenum mTarget;
+    GLsizeiptr mBlockSize;
+    GLsizeiptr mAlignment;
+
+    std::vector<Block> mBlocks;
+  };
+}
+
+#endif
@@ -0,0 +1,74 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_FENCE_H__
+#define __GLTOOLBOX_FENCE_H__
+
+#include "gl.h"
+
+namespace gltoolbox
+{
+  class Fence
+  {
+  public:
+    Fence();
+
+    Fence(const Fence &other) = delete;
+    Fence(Fence &&temp);
+
+    virtual ~Fence();
+
+    Fence &operator=(const Fence &other) = delete;
+    Fence &operator=(Fence &&temp);
+
+    inline GLsync id() const { return mId; }
+    inline bool is_valid() const { return (mId != nullptr) && (glIsSync(mId) == GL_TRUE); }
+
+    //=====================================================
+    // Synchronisation
+    //=====================================================
+
+    //place a fence after all previously issued commands, replaces any pending fence
+    void insert();
+
+    //non-blocking, true once the gpu went past the fence (or when no fence is pending)
+    bool is_signaled();
+
+    //block the cpu until the gpu went past the fence
+    void wait();
+
+    //make the gpu command stream wait on the fence, does not block the cpu
+    void wait_server() const;
+
+  protected:
+    void destroy();
+
+  protected:
+    GLsync mId;
+  };
+}
+
+#endif
@@ -28,6 +28,7 @@
 #define __GL_H__
 
 #include <iostream>
+#include <string>
 
 #include <glbinding/Binding.h>
 #include <glbinding/gl/gl.h>
@@ -56,6 +57,35 @@ namespace gltoolbox
     static const GLubyte *gl_version() { return glGetString(GL_VERSION); }
     static const GLubyte *glsl_version() { return glGetString(GL_SHADING_LANGUAGE_VERSION); }
 
+    static bool has_extension(const std::string &name)
+    {
+      GLint count = 0;
+      glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+      for (GLint i = 0; i < count; ++i)
+      {
+        const GLubyte *ext = glGetStringi(GL_EXTENSIONS, GLuint(i));
+        if (ext && name == reinterpret_cast<const char *>(ext))
+          return true;
+      }
+      return false;
+    }
+
+    //GL_KHR_parallel_shader_compile (or its ARB twin), looked up once on the first call
+    static bool has_parallel_shader_compile()
+    {
+      static const bool supported = has_extension("GL_KHR_parallel_shader_compile") ||
+                                    has_extension("GL_ARB_parallel_shader_compile");
+      return supported;
+    }
+
+    static void set_max_shader_compiler_threads(GLuint count)
+    {
+      if (has_extension("GL_KHR_parallel_shader_compile"))
+        glMaxShaderCompilerThreadsKHR(count);
+      else if (has_extension("GL_ARB_parallel_shader_compile"))
+        glMaxShaderCompilerThreadsARB(count);
+    }
+
     //=====================================================
     // info
     //=====================================================
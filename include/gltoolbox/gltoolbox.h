@@ -30,11 +30,25 @@
 #include "gl.h"
 
 #include "buffer.h"
+#include "bufferarena.h"
+#include "fence.h"
 #include "framebuffer.h"
+#include "gpuvector.h"
+#include "indirectcommandbuffer.h"
+#include "instancestream.h"
+#include "meshpool.h"
 #include "program.h"
+#include "programbatch.h"
+#include "programcache.h"
+#include "readback.h"
 #include "shader.h"
+#include "shadowbuffer.h"
+#include "streambuffer.h"
 #include "texture.h"
 #include "uniform.h"
+#include "uploadqueue.h"
 #include "vertexarray.h"
+#include "vertexlayout.h"
+#include "vertexpuller.h"
 
 #endif // __GLTOOLBOX_H__
\ No newline at end of file
@@ -0,0 +1,141 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_GPUVECTOR_H__
+#define __GLTOOLBOX_GPUVECTOR_H__
+
+#include "buffer.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace gltoolbox
+{
+  // growable typed array living in gpu memory.
+  // capacity grows geometrically and old content is copied on the gpu side,
+  // the Buffer object stays the same so vertex arrays using it do not need to be rebuilt.
+  template <typename T>
+  class GpuVector
+  {
+  public:
+    GpuVector(GLenum target = GL_ARRAY_BUFFER, GLsizei capacity = 0)
+        : mBuffer(std::make_shared<Buffer>(target, sizeof(T))), mSize(0), mCapacity(0)
+    {
+      reserve(capacity);
+    }
+
+    GpuVector(const GpuVector &other) = delete;
+    GpuVector &operator=(const GpuVector &other) = delete;
+
+    virtual ~GpuVector() {}
+
+    //=====================================================
+    // Information
+    //=====================================================
+
+    inline GLsizei size() const { return mSize; }
+    inline GLsizei capacity() const { return mCapacity; }
+    inline bool empty() const { return mSize == 0; }
+
+    inline const std::shared_ptr<Buffer> &buffer() const { return mBuffer; }
+
+    //=====================================================
+    // Capacity
+    //=====================================================
+
+    void reserve(GLsizei capacity)
+    {
+      if (capacity <= mCapacity)
+        return;
+
+      Buffer grown(mBuffer->target(), sizeof(T), mBuffer->usage());
+      grown.allocate_storage(capacity, GL_DYNAMIC_STORAGE_BIT);
+
+      // copy the content without going through cpu memory
+      if (mSize > 0)
+        glCopyNamedBufferSubData(mBuffer->id(), grown.id(), 0, 0, GLsizeiptr(mSize) * sizeof(T));
+
+      *mBuffer = grown;
+      mCapacity = capacity;
+    }
+
+    void resize(GLsizei count)
+    {
+      grow(count);
+      mSize = count;
+    }
+
+    inline void clear() { mSize = 0; }
+
+    //=====================================================
+    // Content
+    //=====================================================
+
+    void push_back(const T &value)
+    {
+      append(&value, 1);
+    }
+
+    void append(const T *data, GLsizei count)
+    {
+      if (count <= 0)
+        return;
+
+      grow(mSize + count);
+      mBuffer->upload((void *)data, mSize, count);
+      mSize += count;
+    }
+
+    //overwrite count elements starting at offset, the vector grows if needed
+    void update(const T *data, GLsizei offset, GLsizei count)
+    {
+      if (offset + count > mSize)
+        resize(offset + count);
+      mBuffer->upload((void *)data, offset, count);
+    }
+
+    void download(T *data, GLsizei offset, GLsizei count) const
+    {
+      mBuffer->download(data, offset * sizeof(T), count * sizeof(T));
+    }
+
+  protected:
+    // amortized growth, at least doubles the capacity
+    void grow(GLsizei count)
+    {
+      if (count > mCapacity)
+        reserve(std::max(count, std::max(2 * mCapacity, GLsizei(16))));
+    }
+
+  protected:
+    std::shared_ptr<Buffer> mBuffer;
+
+    GLsizei mSize;
+    GLsizei mCapacity;
+  };
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_INDIRECTCOMMANDBUFFER_H__
+#define __GLTOOLBOX_INDIRECTCOMMANDBUFFER_H__
+
+#include "buffer.h"
+
+#include <vector>
+
+namespace gltoolbox
+{
+  // layout read by glMultiDrawElementsIndirect
+  struct DrawElementsIndirectCommand
+  {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+  };
+
+  // layout read by glMultiDrawArraysIndirect
+  struct DrawArraysIndirectCommand
+  {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint first;
+    GLuint baseInstance;
+  };
+
+  // draw commands built on the cpu and sent to a GL_DRAW_INDIRECT_BUFFER.
+  // the index of a command is its gl_DrawID in the shader. passing DRAW_ID as base instance
+  // stores the draw id there, so a per-draw attribute with divisor 1 reads the same index
+  // without ARB_shader_draw_parameters.
+  // a buffer holds either indexed or array commands, as chosen at construction.
+  class IndirectCommandBuffer : public Buffer
+  {
+  public:
+    //base instance set to the draw id, only valid for commands with a single instance:
+    //with more, the instances of a draw would read the attributes of the next draws
+    static const GLint DRAW_ID = -1;
+
+    //returned by add_elements and add_arrays when the command is rejected
+    static const GLuint INVALID = GLuint(-1);
+
+  public:
+    IndirectCommandBuffer(bool indexed = true, GLenum usage = GL_DYNAMIC_DRAW);
+
+    IndirectCommandBuffer(const IndirectCommandBuffer &other) = delete;
+    IndirectCommandBuffer(IndirectCommandBuffer &&temp) = delete;
+
+    virtual ~IndirectCommandBuffer();
+
+    IndirectCommandBuffer &operator=(const IndirectCommandBuffer &other) = delete;
+
+    //=====================================================
+    // Command information
+    //=====================================================
+
+    inline bool is_indexed() const { return mIndexed; }
+    inline GLsizei num_commands() const { return GLsizei(mIndexed ? mElements.size() : mArrays.size()); }
+    inline bool is_dirty() const { return mDirty; }
+
+    inline const std::vector<DrawElementsIndirectCommand> &elements_commands() const { return mElements; }
+    inline const std::vector<DrawArraysIndirectCommand> &arrays_commands() const { return mArrays; }
+
+    //=====================================================
+    // Command content
+    //=====================================================
+
+    //returns the draw id of the command, firstindex is counted in indices.
+    //add_elements needs an indexed buffer and add_arrays a non indexed one
+    GLuint add_elements(GLuint count, GLuint firstindex, GLint basevertex = 0, GLuint instancecount = 1, GLint baseinstance = 0);
+    GLuint add_arrays(GLuint count, GLuint first, GLuint instancecount = 1, GLint baseinstance = 0);
+
+    DrawElementsIndirectCommand &elements_command(GLuint drawid);
+    DrawArraysIndirectCommand &arrays_command(GLuint drawid);
+
+    //a command with no instance is skipped by the gpu without changing the draw ids
+    void set_instance_count(GLuint drawid, GLuint instancecount);
+
+    void clear();
+
+    //send the commands to the gpu if they changed
+    void commit();
+
+  protected:
+    //base instance of the next command, INVALID when baseinstance is DRAW_ID with several instances
+    GLuint base_instance(const char *caller, GLuint drawid, GLuint instancecount, GLint baseinstance) const;
+
+  protected:
+    bool mIndexed;
+    bool mDirty;
+
+    std::vector<DrawElementsIndirectCommand> mElements;
+    std::vector<DrawArraysIndirectCommand> mArrays;
+  };
+}
+
+#endif
@@ -0,0 +1,184 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_INSTANCESTREAM_H__
+#define __GLTOOLBOX_INSTANCESTREAM_H__
+
+#include "streambuffer.h"
+#include "vertexarray.h"
+#include "vertexlayout.h"
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+namespace gltoolbox
+{
+  // per-instance data streamed through a ring of fenced regions.
+  // any number of instances can be pushed between begin() and end(), they are drawn with
+  // glDrawElementsInstancedBaseInstance from a cursor inside the current region, so many
+  // begin()/end() pairs share one region. the region is fenced and the stream moves on
+  // only when it is full or at end_frame().
+  // the storage is allocated once, choose capacity * regions to cover the instances in flight.
+  template <typename T>
+  class InstanceStream
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "instances are copied into mapped memory");
+
+  public:
+    InstanceStream(GLsizei capacity = 1024, GLuint regions = 3)
+        : mBuffer(std::make_shared<StreamBuffer>(GL_ARRAY_BUFFER, sizeof(T), capacity, regions)),
+          mVao(nullptr), mPtr(nullptr), mCursor(0), mCount(0), mInstances(0), mBatches(0)
+    {
+    }
+
+    InstanceStream(const InstanceStream &other) = delete;
+    InstanceStream &operator=(const InstanceStream &other) = delete;
+
+    virtual ~InstanceStream() {}
+
+    //=====================================================
+    // Information
+    //=====================================================
+
+    inline const std::shared_ptr<StreamBuffer> &buffer() const { return mBuffer; }
+    inline GLsizei capacity() const { return mBuffer->capacity(); }
+
+    // instances and draw calls since begin()
+    inline GLsizei num_instances() const { return mInstances + mCount; }
+    inline GLsizei num_batches() const { return mBatches; }
+
+    //=====================================================
+    // Setup
+    //=====================================================
+
+    // add the instance attributes described by layout to vao, with divisor 1
+    bool attach(VertexArray &vao, const VertexLayout &layout)
+    {
+      return vao.add_vertices(layout, mBuffer, capacity() * GLsizei(mBuffer->num_regions()), 1);
+    }
+
+    //=====================================================
+    // Streaming
+    //=====================================================
+
+    // instances are drawn with the index buffer of vao, which must be bound
+    void begin(const VertexArray &vao)
+    {
+      mVao = &vao;
+      mInstances = 0;
+      mBatches = 0;
+    }
+
+    // slot for the next instance
+    T &push()
+    {
+      if (mCursor + mCount == capacity())
+        next_region();
+      if (mPtr == nullptr)
+        open();
+      return mPtr[mCursor + mCount++];
+    }
+
+    inline void push(const T &instance) { push() = instance; }
+
+    void push(const T *instances, GLsizei count)
+    {
+      while (count > 0)
+      {
+        if (mCursor + mCount == capacity())
+          next_region();
+        if (mPtr == nullptr)
+          open();
+
+        GLsizei n = std::min(count, capacity() - mCursor - mCount);
+        std::copy(instances, instances + n, mPtr + mCursor + mCount);
+        mCount += n;
+        instances += n;
+        count -= n;
+      }
+    }
+
+    // draw the pending instances, the next begin() keeps writing in the same region
+    void end()
+    {
+      flush();
+      mVao = nullptr;
+    }
+
+    // fence the commands issued from the current region and move to the next one,
+    // call once per frame after the last end()
+    void end_frame()
+    {
+      if (mCursor + mCount > 0)
+        next_region();
+    }
+
+  protected:
+    // waits for the gpu to release the current region
+    void open()
+    {
+      mPtr = mBuffer->template region_ptr<T>();
+      mCursor = 0;
+      mCount = 0;
+    }
+
+    // draw the instances written since the cursor and move the cursor past them
+    void flush()
+    {
+      if (mCount == 0)
+        return;
+
+      mVao->draw_elements_base_instance(mCount, GLuint(mBuffer->region_first() + mCursor));
+      mInstances += mCount;
+      ++mBatches;
+
+      mCursor += mCount;
+      mCount = 0;
+    }
+
+    void next_region()
+    {
+      flush();
+      mBuffer->next_region();
+      mPtr = nullptr;
+      mCursor = 0;
+    }
+
+  protected:
+    std::shared_ptr<StreamBuffer> mBuffer;
+
+    const VertexArray *mVao;
+    T *mPtr;
+    GLsizei mCursor; // instances of the current region already drawn
+    GLsizei mCount;  // instances written after the cursor
+
+    GLsizei mInstances;
+    GLsizei mBatches;
+  };
+}
+
+#endif
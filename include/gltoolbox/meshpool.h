@@ -0,0 +1,132 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_MESHPOOL_H__
+#define __GLTOOLBOX_MESHPOOL_H__
+
+#include "gpuvector.h"
+#include "indirectcommandbuffer.h"
+#include "vertexarray.h"
+#include "vertexlayout.h"
+
+#include <vector>
+
+namespace gltoolbox
+{
+  // many meshes sharing the vertex layout packed in the buffers of a single vertex array.
+  // indices of a mesh stay relative to its first vertex and are drawn with a base vertex,
+  // so all meshes are drawn without switching vertex arrays.
+  class MeshPool
+  {
+  public:
+    struct Mesh
+    {
+      GLint baseVertex;
+      GLuint firstIndex;
+      GLsizei count;       // number of indices
+      GLsizei numVertices;
+    };
+
+  public:
+    MeshPool(const VertexLayout &layout, GLenum mode = GL_TRIANGLES);
+
+    MeshPool(const MeshPool &other) = delete;
+    MeshPool(MeshPool &&temp) = delete;
+
+    virtual ~MeshPool();
+
+    MeshPool &operator=(const MeshPool &other) = delete;
+
+    //=====================================================
+    // Information
+    //=====================================================
+
+    inline const VertexLayout &layout() const { return mLayout; }
+    inline GLenum mode() const { return mMode; }
+
+    inline size_t num_meshes() const { return mMeshes.size(); }
+    inline GLsizei num_vertices() const { return mVertices.size() / mLayout.stride(); }
+    inline GLsizei num_indices() const { return mIndices.size(); }
+
+    inline const Mesh &mesh(GLuint id) const { return mMeshes.at(id); }
+
+    // the buffers can be given to other vertex arrays (see VertexArray::add_vertices)
+    inline const std::shared_ptr<Buffer> &vertex_buffer() const { return mVertices.buffer(); }
+    inline const std::shared_ptr<Buffer> &index_buffer() const { return mIndices.buffer(); }
+
+    inline VertexArray &vertex_array() { return mVao; }
+    inline const VertexArray &vertex_array() const { return mVao; }
+
+    //=====================================================
+    // Meshes
+    //=====================================================
+
+    //append a mesh, indices are relative to its first vertex. returns the mesh id
+    GLuint add(const void *vertices, GLsizei numvertices, const GLuint *indices, GLsizei numindices);
+
+    template <typename V>
+    inline GLuint add(const V *vertices, GLsizei numvertices, const GLuint *indices, GLsizei numindices)
+    {
+      return add(static_cast<const void *>(vertices), numvertices, indices, numindices);
+    }
+
+    void clear();
+
+    //=====================================================
+    // Drawing
+    //=====================================================
+
+    inline void enable_attributes(const Program &program) const { mVao.enable_attributes(program); }
+
+    inline void bind() const { mVao.bind(); }
+    inline void unbind() const { mVao.unbind(); }
+
+    void draw(GLuint id) const;
+
+    //all meshes in ids with a single call
+    void draw(const std::vector<GLuint> &ids) const;
+
+    //append the draw command of a mesh, returns its draw id (IndirectCommandBuffer::INVALID when rejected)
+    GLuint add_command(IndirectCommandBuffer &commands, GLuint id, GLuint instancecount = 1, GLint baseinstance = 0) const;
+
+  protected:
+    VertexLayout mLayout;
+    GLenum mMode;
+
+    GpuVector<char> mVertices;
+    GpuVector<GLuint> mIndices;
+    VertexArray mVao;
+
+    std::vector<Mesh> mMeshes;
+
+    // scratch arrays of the multi draw
+    mutable std::vector<GLsizei> mCounts;
+    mutable std::vector<const GLvoid *> mOffsets;
+    mutable std::vector<GLint> mBaseVertices;
+  };
+}
+
+#endif
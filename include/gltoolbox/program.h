@@ -27,9 +27,11 @@
 #ifndef __GLTOOLBOX_PROGRAM_H__
 #define __GLTOOLBOX_PROGRAM_H__
 
+#include "programcache.h"
 #include "shader.h"
 #include "uniform.h"
 
+#include <map>
 #include <unordered_map>
 
 namespace gltoolbox
@@ -47,12 +49,29 @@ namespace gltoolbox
     Program &operator=(const Program &other) = delete;
 
     inline GLuint id() const { return mId; }
+
+    //unique to each program object created, unlike the id that drivers reuse once deleted
+    inline size_t generation() const { return mGeneration; }
     inline bool is_valid() const { return (glIsProgram(mId) == GL_TRUE); }
 
     bool link() const;
+
+    //issue the link without waiting for its status, see completion_status()
+    void link_deferred() const;
+
+    //attach, compile and link the sources, or load the binary from the cache when it holds one.
+    //the binary of a freshly linked program is added to the cache
+    bool link(ProgramCache &cache, const std::map<GLenum, std::string> &sources);
+
     inline bool link_status() const { return get_parameter(GL_LINK_STATUS) != 0; }
     inline bool delete_status() const { return get_parameter(GL_DELETE_STATUS) != 0; }
 
+    //false while the driver is still linking, always true without parallel shader compile
+    inline bool completion_status() const
+    {
+      return !GL::has_parallel_shader_compile() || get_parameter(GL_COMPLETION_STATUS_KHR) != 0;
+    }
+
     inline void use() const { glUseProgram(mId); }
     inline void unuse() const { glUseProgram(0); }
 
@@ -65,7 +84,7 @@ namespace gltoolbox
     bool has_shader(GLenum type);
     inline const std::shared_ptr<Shader> &get_shader(GLenum type) const { return mShaderList.at(type); }
 
-    void attach_shader(const std::string &src, GLenum type);
+    void attach_shader(const std::string &src, GLenum type, bool deferred = false);
     void attach_shader(const std::shared_ptr<Shader> &shader);
 
     void detach_shader(GLenum type);
@@ -134,6 +153,13 @@ namespace gltoolbox
 
     void remove_uniform(const std::string &name);
 
+    //sum of the upload statistics of every uniform
+    BaseUniform::Statistics uniform_statistics() const;
+    void reset_uniform_statistics() const;
+
+    //linking resets uniform values, the next enable uploads every uniform
+    void invalidate_uniforms() const;
+
     //============================
     // Program Info
     //============================
@@ -152,6 +178,7 @@ namespace gltoolbox
   protected:
     GLuint mId;
     bool mOwned;
+    size_t mGeneration;
 
     // std::unordered_map<GLenum, Shader> mShaderList;
     std::unordered_map<GLenum, std::shared_ptr<Shader>> mShaderList;
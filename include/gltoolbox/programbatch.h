@@ -0,0 +1,110 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_PROGRAMBATCH_H__
+#define __GLTOOLBOX_PROGRAMBATCH_H__
+
+#include "program.h"
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gltoolbox
+{
+  // compiles and links a set of programs concurrently.
+  // every shader of every program is submitted first, then every link, and the status
+  // is only queried once the driver reports completion (GL_KHR_parallel_shader_compile).
+  // without the extension poll() blocks on each program in turn, like Program::link()
+  class ProgramBatch
+  {
+  public:
+    struct Timing
+    {
+      double submit; // ms spent issuing the compile and link commands
+      double ready;  // ms from submit() until the program was seen complete
+    };
+
+  public:
+    //when a cache is given, cached binaries are loaded instead of compiled and new ones are stored
+    ProgramBatch(ProgramCache *cache = nullptr);
+
+    ProgramBatch(const ProgramBatch &other) = delete;
+
+    virtual ~ProgramBatch();
+
+    ProgramBatch &operator=(const ProgramBatch &other) = delete;
+
+    //program must outlive the batch, returns its index
+    size_t add(Program &program, const std::map<GLenum, std::string> &sources);
+
+    inline size_t size() const { return mEntries.size(); }
+    inline bool is_complete() const { return mPending == 0; }
+
+    void submit();
+
+    //finish the programs the driver is done with, true when every program is complete
+    bool poll();
+
+    //block until every program is complete, true when they all linked
+    bool wait();
+
+    inline bool link_status(size_t i) const { return mEntries.at(i).linked; }
+    inline bool from_cache(size_t i) const { return mEntries.at(i).cached; }
+    inline const Timing &timing(size_t i) const { return mEntries.at(i).timing; }
+
+    //ms from submit() until the last program completed
+    inline double elapsed() const { return mElapsed; }
+
+    void clear();
+
+  protected:
+    struct Entry
+    {
+      Program *program;
+      std::map<GLenum, std::string> sources;
+      std::string key;
+      bool cached;
+      bool complete;
+      bool linked;
+      Timing timing;
+    };
+
+    void finish(Entry &entry);
+    double since_submit() const;
+
+  protected:
+    ProgramCache *mCache;
+    std::vector<Entry> mEntries;
+    size_t mPending;
+
+    std::chrono::steady_clock::time_point mStart;
+    double mElapsed;
+  };
+}
+
+#endif
@@ -0,0 +1,88 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_PROGRAMCACHE_H__
+#define __GLTOOLBOX_PROGRAMCACHE_H__
+
+#include "gl.h"
+
+#include <map>
+#include <string>
+
+namespace gltoolbox
+{
+  class Program; //forward declaration of program class
+
+  // directory of linked program binaries (glGetProgramBinary).
+  // entries are keyed by a hash of the shader sources, the driver vendor/renderer/version
+  // and the supported binary formats, so a driver update invalidates them.
+  // see Program::link(ProgramCache &, sources)
+  class ProgramCache
+  {
+  public:
+    struct Statistics
+    {
+      size_t hits;
+      size_t misses;
+      size_t rejected; // binaries refused by the driver, the program was compiled instead
+      size_t stored;
+    };
+
+  public:
+    ProgramCache(const std::string &directory);
+
+    ProgramCache(const ProgramCache &other) = delete;
+
+    virtual ~ProgramCache();
+
+    ProgramCache &operator=(const ProgramCache &other) = delete;
+
+    inline const std::string &directory() const { return mDirectory; }
+    inline const Statistics &statistics() const { return mStatistics; }
+
+    //key of a set of sources for the current driver, needs a current context
+    std::string key(const std::map<GLenum, std::string> &sources);
+
+    //load the cached binary into program, false when missing or rejected
+    bool load(const std::string &key, const Program &program);
+
+    //save the binary of a linked program
+    bool store(const std::string &key, const Program &program);
+
+    //remove every entry of the directory
+    void clear();
+
+  protected:
+    std::string filename(const std::string &key) const;
+
+  protected:
+    std::string mDirectory;
+    std::string mDriver; // driver identification, queried on first use
+    Statistics mStatistics;
+  };
+}
+
+#endif
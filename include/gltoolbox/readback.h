@@ -0,0 +1,97 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_READBACK_H__
+#define __GLTOOLBOX_READBACK_H__
+
+#include "gl.h"
+#include "fence.h"
+
+#include <memory>
+#include <thread>
+
+namespace gltoolbox
+{
+  class Buffer; //forward declaration of buffer class
+
+  // pending copy of a buffer range into cpu visible memory.
+  // the copy goes to a persistently mapped staging buffer and is guarded by a fence,
+  // the result can be picked up later without stalling the cpu.
+  // staging buffers are returned to a small pool when the readback is destroyed and reused
+  // by the next requests, the gpu runs the copies in order so a reused buffer is never raced.
+  // the pool belongs to the calling thread and so to the context current on it, a loader
+  // thread with its own context has its own pool. a readback destroyed on another thread
+  // than the one that created it deletes its staging buffer instead of pooling it.
+  class Readback
+  {
+  public:
+    Readback();
+    Readback(const Buffer &source, GLintptr offset, GLsizeiptr size);
+
+    Readback(const Readback &other) = delete;
+    Readback(Readback &&temp);
+
+    virtual ~Readback();
+
+    Readback &operator=(const Readback &other) = delete;
+    Readback &operator=(Readback &&temp);
+
+    //delete the staging buffers pooled by the calling thread, call before destroying its context
+    static void release_staging();
+
+    //false for default constructed and empty (size 0) readbacks
+    inline bool is_valid() const { return mPtr != nullptr; }
+    inline GLsizeiptr size() const { return mSize; }
+
+    //non-blocking, true once the copy is complete
+    bool ready();
+
+    //block until the copy is complete
+    void wait();
+
+    //mapped staging memory, waits for the copy if it is not complete yet
+    const void *data();
+
+    template <typename T>
+    inline const T *data() { return static_cast<const T *>(data()); }
+
+  protected:
+    //give the staging buffer back to the pool
+    void release();
+
+  protected:
+    std::unique_ptr<Buffer> mStaging;
+    Fence mFence;
+
+    const void *mPtr;
+    GLsizeiptr mSize;
+
+    //thread whose pool the staging buffer goes back to
+    std::thread::id mOwner;
+  };
+}
+
+#endif
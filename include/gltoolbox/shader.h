@@ -40,7 +40,8 @@ namespace gltoolbox
 
   public:
     Shader();
-    Shader(const std::string &src, GLenum type);
+    //deferred shaders are submitted to the driver without waiting for the compile status
+    Shader(const std::string &src, GLenum type, bool deferred = false);
 
     Shader(const Shader &other) = delete;
     Shader(Shader &&temp);
@@ -58,6 +59,12 @@ namespace gltoolbox
     bool compile() const;
     inline bool compile_status() const { return get_parameter(GL_COMPILE_STATUS) != 0; }
 
+    //false while the driver is still compiling, always true without parallel shader compile
+    inline bool completion_status() const
+    {
+      return !GL::has_parallel_shader_compile() || get_parameter(GL_COMPLETION_STATUS_KHR) != 0;
+    }
+
     inline bool delete_status() const { return get_parameter(GL_DELETE_STATUS) != 0; }
 
     std::string info_log() const;
@@ -70,7 +77,7 @@ namespace gltoolbox
     void create(GLenum type);
     void destroy();
 
-    void set_source(const std::string &src) const;
+    void set_source(const std::string &src, bool deferred = false) const;
     void set_source_file(const std::string &filename);
 
     GLint get_parameter(const GLenum param) const;
@@ -0,0 +1,107 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_SHADOWBUFFER_H__
+#define __GLTOOLBOX_SHADOWBUFFER_H__
+
+#include "buffer.h"
+
+#include <map>
+#include <vector>
+
+namespace gltoolbox
+{
+  // buffer keeping a cpu copy of its content.
+  // writes go to the cpu copy and are recorded as dirty byte ranges,
+  // flush() only uploads those ranges. ranges closer than the merge distance
+  // are merged so that many small writes end up in a few uploads.
+  class ShadowBuffer : public Buffer
+  {
+  public:
+    ShadowBuffer(GLenum target, GLsizei elementsize, GLenum usage = GL_DYNAMIC_DRAW, GLsizeiptr mergedistance = 256);
+
+    ShadowBuffer(const ShadowBuffer &other) = delete;
+    ShadowBuffer(ShadowBuffer &&temp) = delete;
+
+    virtual ~ShadowBuffer();
+
+    ShadowBuffer &operator=(const ShadowBuffer &other) = delete;
+
+    //=====================================================
+    // Shadow information
+    //=====================================================
+
+    inline GLsizei count() const { return GLsizei(mShadow.size() / element_size()); }
+
+    inline const void *data() const { return mShadow.data(); }
+
+    template <typename T>
+    inline const T *data() const { return reinterpret_cast<const T *>(mShadow.data()); }
+
+    inline bool is_dirty() const { return !mDirty.empty(); }
+    GLsizeiptr dirty_bytes() const;
+    inline size_t num_dirty_ranges() const { return mDirty.size(); }
+
+    inline GLsizeiptr merge_distance() const { return mMergeDistance; }
+    inline void set_merge_distance(GLsizeiptr distance) { mMergeDistance = distance; }
+
+    //=====================================================
+    // Shadow content
+    //=====================================================
+
+    //resize the cpu copy, the gpu store grows geometrically.
+    //only the added elements are dirty, unless the gpu store was reallocated
+    void resize(GLsizei count);
+
+    //elements the gpu store can hold without being reallocated
+    inline GLsizei capacity() const { return GLsizei(mSize / element_size()); }
+
+    //offset and count are in elements
+    void write(const void *ptr, GLsizei offset, GLsizei count);
+
+    //writable pointer on the cpu copy, the range is marked dirty
+    void *map(GLsizei offset, GLsizei count);
+
+    template <typename T>
+    inline T *map(GLsizei offset, GLsizei count) { return static_cast<T *>(map(offset, count)); }
+
+    void mark_dirty(GLsizei offset, GLsizei count);
+
+    //upload the dirty ranges, returns the number of bytes sent
+    GLsizeiptr flush();
+
+  protected:
+    void mark_dirty_bytes(GLintptr begin, GLintptr end);
+
+  protected:
+    std::vector<char> mShadow;
+
+    std::map<GLintptr, GLintptr> mDirty; // disjoint byte intervals, begin -> end
+    GLsizeiptr mMergeDistance;
+  };
+}
+
+#endif
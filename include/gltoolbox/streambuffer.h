@@ -0,0 +1,107 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_STREAMBUFFER_H__
+#define __GLTOOLBOX_STREAMBUFFER_H__
+
+#include "buffer.h"
+#include "fence.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace gltoolbox
+{
+  // persistently mapped buffer split in several regions (one per frame in flight).
+  // the cpu writes into the current region while the gpu reads from the previous ones,
+  // each region is guarded by a fence so it is never overwritten while still in use.
+  class StreamBuffer : public Buffer
+  {
+  public:
+    StreamBuffer(GLenum target, GLsizei elementsize, GLsizei capacity, GLuint regions = 3);
+
+    StreamBuffer(const StreamBuffer &other) = delete;
+    StreamBuffer(StreamBuffer &&temp) = delete;
+
+    virtual ~StreamBuffer();
+
+    StreamBuffer &operator=(const StreamBuffer &other) = delete;
+
+    //=====================================================
+    // Stream information
+    //=====================================================
+
+    // number of elements per region
+    inline GLsizei capacity() const { return mCapacity; }
+    inline GLuint num_regions() const { return GLuint(mFences.size()); }
+    inline GLuint current_region() const { return mRegion; }
+
+    // position of the current region in the buffer
+    inline GLsizei region_first() const { return mRegion * mCapacity; }
+    inline GLsizei region_offset() const { return region_first() * element_size(); }
+
+    //=====================================================
+    // Stream operations
+    //=====================================================
+
+    // pointer to the start of the current region,
+    // blocks until the gpu is done reading from that region
+    void *region_ptr();
+
+    template <typename T>
+    inline T *region_ptr() { return static_cast<T *>(region_ptr()); }
+
+    // copy count elements at the start of the current region
+    void write(const void *ptr, GLsizei count);
+
+    // thread-safe and gl free: reserves count elements in the current region and returns
+    // the index of the first one in the buffer, or -1 when the region is full.
+    // region_ptr() must have been called on the gl thread before handing out work.
+    GLsizei reserve(GLsizei count);
+
+    inline void *element_ptr(GLsizei index) const { return static_cast<char *>(mPtr) + GLintptr(index) * element_size(); }
+
+    template <typename T>
+    inline T *element_ptr(GLsizei index) const { return static_cast<T *>(element_ptr(index)); }
+
+    // number of elements reserved in the current region
+    inline GLsizei region_count() const { return mReserved; }
+
+    // fence the commands reading from the current region and move to the next one
+    void next_region();
+
+  protected:
+    void *mPtr;
+
+    GLsizei mCapacity;
+    GLuint mRegion;
+    std::vector<Fence> mFences;
+
+    std::atomic<GLsizei> mReserved;
+  };
+}
+
+#endif
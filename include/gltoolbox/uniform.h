@@ -30,6 +30,9 @@
 #include "gl.h"
 
 #include <array>
+#include <cstring>
+#include <string>
+#include <vector>
 
 #ifdef GLTOOLBOX_ENABLE_EIGEN
 #include <Eigen/Dense>
@@ -41,6 +44,13 @@ namespace gltoolbox
 
   class BaseUniform
   {
+  public:
+    struct Statistics
+    {
+      size_t uploads;
+      size_t redundant; // updates skipped because the value matched the last upload
+    };
+
   public:
     BaseUniform(Program *prog, GLint location);
     BaseUniform(Program *prog, const std::string &name);
@@ -54,7 +64,32 @@ namespace gltoolbox
     virtual bool is_attached() const = 0;
     virtual void update() const = 0;
 
+    inline const Statistics &statistics() const { return mStatistics; }
+    inline void reset_statistics() const { mStatistics = {0, 0}; }
+
+    //forget the last uploaded value, the next update always uploads (e.g. after a relink)
+    inline void invalidate() const { mShadow.clear(); }
+
   protected:
+    //upload unless data matches the last uploaded value byte for byte
+    template <typename T>
+    void upload(GLsizei cnt, T *data) const
+    {
+      if (data == nullptr || cnt <= 0)
+        return;
+
+      size_t size = sizeof(T) * size_t(cnt);
+      if (mShadow.size() == size && std::memcmp(mShadow.data(), data, size) == 0)
+      {
+        mStatistics.redundant++;
+        return;
+      }
+
+      update_value(cnt, data);
+      mShadow.assign(reinterpret_cast<const char *>(data), reinterpret_cast<const char *>(data) + size);
+      mStatistics.uploads++;
+    }
+
     // glProgramUniform1{i|ui|f|d}
     void update_value(GLsizei cnt, int *data) const;
     void update_value(GLsizei cnt, unsigned int *data) const;
@@ -137,6 +172,10 @@ namespace gltoolbox
 
     GLint mLocation;
     std::string mName;
+
+    //copy of the last uploaded value
+    mutable std::vector<char> mShadow;
+    mutable Statistics mStatistics;
   };
 
   template <typename T>
@@ -146,19 +185,19 @@ namespace gltoolbox
     Uniform(Program *prog, GLint location, T *data = nullptr, GLsizei count = 1)
         : BaseUniform(prog, location), mPtr(data), mCount(count)
     {
-      mIsAttached = (data == nullptr);
+      mIsAttached = (data != nullptr);
     }
 
     Uniform(Program *prog, const std::string &name, T *data = nullptr, GLsizei count = 1)
         : BaseUniform(prog, name), mPtr(data), mCount(count)
     {
-      mIsAttached = (data == nullptr);
+      mIsAttached = (data != nullptr);
     }
 
     Uniform(Program *prog, GLint location, const std::string &name, T *data = nullptr, GLsizei count = 1)
         : BaseUniform(prog, location, name), mPtr(data), mCount(count)
     {
-      mIsAttached = (data == nullptr);
+      mIsAttached = (data != nullptr);
     }
 
     virtual ~Uniform()
@@ -188,12 +227,12 @@ namespace gltoolbox
     virtual void update() const
     {
       if (is_attached())
-        update_value(mCount, mPtr);
+        upload(mCount, mPtr);
     }
 
     void update(T *data, GLsizei count = 1)
     {
-      update_value(count, data);
+      upload(count, data);
     }
 
   protected:
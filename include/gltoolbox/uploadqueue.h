@@ -0,0 +1,125 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_UPLOADQUEUE_H__
+#define __GLTOOLBOX_UPLOADQUEUE_H__
+
+#include "bufferarena.h"
+#include "streambuffer.h"
+#include "texture.h"
+
+#include <memory>
+#include <vector>
+
+namespace gltoolbox
+{
+  // gathers many small buffer and texture updates into one staging buffer.
+  // nothing reaches the destinations before flush(), which issues one copy per
+  // contiguous run of data for each destination.
+  // ! destinations must outlive the next flush. buffers are resolved at flush time,
+  // ! updates to a buffer whose store was reallocated since enqueue() are dropped
+  class UploadQueue
+  {
+  public:
+    struct Statistics
+    {
+      GLsizeiptr bytes; // bytes copied from the staging buffer
+      size_t requests;  // number of queued updates
+      size_t commands;  // number of copy commands issued
+      size_t dropped;   // updates dropped because the destination store was reallocated
+    };
+
+  protected:
+    struct BufferRequest
+    {
+      const Buffer *dst;
+      size_t generation; // store the offsets refer to
+      GLintptr dstOffset;
+      GLintptr srcOffset;
+      GLsizeiptr size;
+    };
+
+    struct TextureRequest
+    {
+      const Texture *dst;
+      GLuint dim;
+      GLenum format;
+      GLenum type;
+      GLint alignment;
+      GLint level;
+      GLint x, y, z;
+      GLsizei width, height, depth;
+      GLintptr srcOffset;
+      GLsizeiptr size;
+    };
+
+  public:
+    UploadQueue(GLsizeiptr capacity = 1 << 22, GLuint regions = 2);
+
+    UploadQueue(const UploadQueue &other) = delete;
+
+    virtual ~UploadQueue();
+
+    UploadQueue &operator=(const UploadQueue &other) = delete;
+
+    inline GLsizeiptr capacity() const { return mStaging->capacity(); }
+    inline GLsizeiptr pending_bytes() const { return mCursor; }
+    inline size_t pending_requests() const { return mBufferRequests.size() + mTextureRequests.size(); }
+
+    //=====================================================
+    // Requests
+    //=====================================================
+
+    //offset and size are in bytes
+    void enqueue(const Buffer &dst, GLintptr offset, const void *ptr, GLsizeiptr size);
+    void enqueue(const BufferRange &dst, GLintptr offset, const void *ptr, GLsizeiptr size);
+
+    //ptr is laid out with the texture format and type, and the current unpack alignment
+    void enqueue(const Texture &dst, const void *ptr,
+                 GLsizei width, GLsizei height = 1, GLsizei depth = 1,
+                 GLint x = 0, GLint y = 0, GLint z = 0, GLint level = 0);
+
+    //issue all pending copies, the staging memory is reused once the gpu is done with it
+    void flush();
+
+    //statistics of the last flush
+    inline const Statistics &statistics() const { return mStats; }
+
+  protected:
+    GLintptr stage(const void *ptr, GLsizeiptr size, GLsizeiptr alignment);
+
+  protected:
+    std::unique_ptr<StreamBuffer> mStaging;
+    GLintptr mCursor;
+
+    std::vector<BufferRequest> mBufferRequests;
+    std::vector<TextureRequest> mTextureRequests;
+
+    Statistics mStats;
+  };
+}
+
+#endif
@@ -0,0 +1,123 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_GPUCULLER_H__
+#define __GLTOOLBOX_GPUCULLER_H__
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <gltoolbox/buffer.h>
+#include <gltoolbox/program.h>
+#include <gltoolbox/texture.h>
+#include <gltoolbox/vertexarray.h>
+
+namespace gltoolbox
+{
+  // bounds and draw command of an object, std430 layout of the culling shader
+  struct CullObject
+  {
+    float center[3];
+    float radius;
+    GLuint count;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+  };
+
+  // compute shader culling objects against the frustum and optionally a depth pyramid.
+  // surviving objects are compacted into indirect draw commands and counted on the gpu,
+  // nothing is read back: draw() uses glMultiDrawElementsIndirectCount (GL 4.6).
+  class GpuCuller
+  {
+  public:
+    GpuCuller(bool doInit = false);
+
+    GpuCuller(const GpuCuller &other) = delete;
+
+    virtual ~GpuCuller();
+
+    GpuCuller &operator=(const GpuCuller &other) = delete;
+
+    //=====================================================
+    // Objects
+    //=====================================================
+
+    inline GLsizei num_objects() const { return mNumObjects; }
+
+    //objects share the index buffer of the vertex array they are drawn with (e.g. a MeshPool)
+    void set_objects(const std::vector<CullObject> &objects);
+
+    //=====================================================
+    // Occlusion
+    //=====================================================
+
+    //max-reduced mip chain of a depth texture, usually the depth of the previous frame
+    void build_depth_pyramid(const Texture &depth, GLsizei width, GLsizei height);
+
+    inline void set_occlusion(bool enabled) { mUseOcclusion = enabled; }
+    inline bool has_depth_pyramid() const { return mPyramid != nullptr; }
+    inline const std::unique_ptr<Texture> &depth_pyramid() const { return mPyramid; }
+
+    //=====================================================
+    // Culling
+    //=====================================================
+
+    //viewproj is the column major view-projection matrix (object space to clip space)
+    void cull(const float *viewproj);
+
+    inline const Buffer &commands() const { return *mCommands; }
+    inline const Buffer &draw_count() const { return *mDrawCount; }
+
+    void draw(const VertexArray &vao) const;
+
+    //reads the count back, stalls until the culling is done. for debugging and statistics
+    GLuint read_draw_count() const;
+
+  protected:
+    void init();
+
+  protected:
+    bool mIsInit;
+
+    Program mCullPrg;
+    Program mReducePrg;
+
+    GLsizei mNumObjects;
+    std::unique_ptr<Buffer> mObjects;
+    std::unique_ptr<Buffer> mCommands;
+    std::unique_ptr<Buffer> mDrawCount;
+
+    bool mUseOcclusion;
+    std::unique_ptr<Texture> mPyramid;
+    GLsizei mPyramidWidth;
+    GLsizei mPyramidHeight;
+    GLint mPyramidLevels;
+  };
+}
+
+#endif
@@ -0,0 +1,160 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_LOADER_H__
+#define __GLTOOLBOX_LOADER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gltoolbox/buffer.h>
+#include <gltoolbox/fence.h>
+#include <gltoolbox/texture.h>
+
+namespace gltoolbox
+{
+  // object created on the loader thread.
+  // it can be used on the render thread once ready() returns true.
+  template <typename T>
+  class LoadTask
+  {
+    friend class Loader;
+
+  public:
+    LoadTask() : mDone(false) {}
+
+    LoadTask(const LoadTask &other) = delete;
+    LoadTask &operator=(const LoadTask &other) = delete;
+
+    //non-blocking, true once the object is created and its data reached the gpu
+    bool ready()
+    {
+      return mDone.load(std::memory_order_acquire) && mFence.is_signaled();
+    }
+
+    //blocks until ready, sleeps until the loader thread publishes the object
+    const std::shared_ptr<T> &get()
+    {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mPublished.wait(lock, [this]() { return mDone.load(std::memory_order_acquire); });
+      }
+      mFence.wait();
+      return mObject;
+    }
+
+  protected:
+    //called by the loader thread once the object and its fence are set
+    void publish()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mDone.store(true, std::memory_order_release);
+      }
+      mPublished.notify_all();
+    }
+
+  protected:
+    std::atomic<bool> mDone;
+    std::mutex mMutex;
+    std::condition_variable mPublished;
+
+    std::shared_ptr<T> mObject;
+    Fence mFence;
+  };
+
+  // background thread running gl jobs in a context shared with the render context.
+  // the context is provided by the application: activate is called on the loader thread and
+  // must make a shared context current and initialize the bindings for it
+  // (e.g. a hidden glfw window created with the render window as share, or an EGL surfaceless context).
+  class Loader
+  {
+  public:
+    Loader(std::function<void()> activate, std::function<void()> deactivate = nullptr);
+
+    Loader(const Loader &other) = delete;
+
+    virtual ~Loader();
+
+    Loader &operator=(const Loader &other) = delete;
+
+    inline size_t pending_jobs() const { return mPending; }
+
+    //=====================================================
+    // Jobs
+    //=====================================================
+
+    //run job on the loader thread, the returned task publishes its result to the render thread
+    template <typename T>
+    std::shared_ptr<LoadTask<T>> submit(std::function<std::shared_ptr<T>()> job)
+    {
+      auto task = std::make_shared<LoadTask<T>>();
+      push([task, job]() {
+        task->mObject = job();
+        task->mFence.insert();
+        glFlush(); // the fence must reach the gpu to be visible from the render context
+        task->publish();
+      });
+      return task;
+    }
+
+    std::shared_ptr<LoadTask<Buffer>> load_buffer(GLenum target, GLsizei elementsize,
+                                                  std::vector<char> data, GLenum usage = GL_STATIC_DRAW);
+
+    std::shared_ptr<LoadTask<Texture>> load_texture(GLenum target, GLenum format, GLenum type,
+                                                     std::vector<char> pixels,
+                                                     GLsizei width, GLsizei height = 1, GLsizei depth = 1,
+                                                     bool mipmaps = false);
+
+    //block until every submitted job ran
+    void finish();
+
+  protected:
+    void push(std::function<void()> job);
+    void run();
+
+  protected:
+    std::function<void()> mActivate;
+    std::function<void()> mDeactivate;
+
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::condition_variable mIdle;
+
+    std::deque<std::function<void()>> mJobs;
+    std::atomic<size_t> mPending;
+    bool mStop;
+  };
+}
+
+#endif
@@ -0,0 +1,139 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_MESHLETS_H__
+#define __GLTOOLBOX_MESHLETS_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gltoolbox/vertexarray.h>
+
+namespace gltoolbox
+{
+  // cluster of consecutive triangles of an index buffer
+  struct Meshlet
+  {
+    GLuint firstIndex;
+    GLsizei count;
+
+    float center[3]; // bounding sphere
+    float radius;
+
+    float coneAxis[3]; // normal cone, coneCutoff is the sine of its half angle (1 when it can not be culled)
+    float coneCutoff;
+  };
+
+  //split a triangle list in runs of at most maxtriangles triangles using at most maxvertices vertices.
+  //meshlets follow the index order, run optimize_vertex_cache first for compact clusters.
+  //positions are 3 floats at the start of each vertex
+  std::vector<Meshlet> build_meshlets(const GLuint *indices, GLsizei count,
+                                      const float *positions, GLsizei stride,
+                                      GLsizei maxtriangles = 124, GLsizei maxvertices = 64);
+
+  // culls meshlets against the view frustum and their normal cone on a pool of threads.
+  // visible meshlets are merged into index ranges drawn with a single multi draw.
+  class ClusterCuller
+  {
+  public:
+    struct Statistics
+    {
+      size_t meshlets;
+      size_t frustumCulled;
+      size_t backfaceCulled;
+      size_t ranges;
+    };
+
+  public:
+    ClusterCuller(unsigned numthreads = std::thread::hardware_concurrency());
+
+    ClusterCuller(const ClusterCuller &other) = delete;
+
+    virtual ~ClusterCuller();
+
+    ClusterCuller &operator=(const ClusterCuller &other) = delete;
+
+    inline unsigned num_threads() const { return unsigned(mWorkers.size()) + 1; }
+
+    //=====================================================
+    // Culling
+    //=====================================================
+
+    //viewproj is the column major view-projection matrix and eye the camera position, both in object space.
+    //returns the number of visible index ranges
+    GLsizei cull(const std::vector<Meshlet> &meshlets, const float *viewproj, const float *eye);
+
+    inline const std::vector<GLuint> &first_indices() const { return mFirst; }
+    inline const std::vector<GLsizei> &counts() const { return mCounts; }
+
+    inline const Statistics &statistics() const { return mStatistics; }
+
+    //draw the visible ranges, the vertex array must hold the index buffer of the meshlets
+    void draw(const VertexArray &vao) const;
+
+  protected:
+    // meshlets per chunk below which fewer threads are used
+    static const size_t MIN_CHUNK = 2048;
+
+    // per thread output
+    struct Chunk
+    {
+      std::vector<GLuint> first;
+      std::vector<GLsizei> counts;
+      size_t frustumCulled;
+      size_t backfaceCulled;
+    };
+
+    void cull_chunk(unsigned chunk);
+    void run(unsigned chunk);
+
+  protected:
+    std::vector<std::thread> mWorkers;
+    std::mutex mMutex;
+    std::condition_variable mStart;
+    std::condition_variable mDone;
+    size_t mGeneration;
+    unsigned mRunning;
+    bool mStop;
+
+    // current job
+    const std::vector<Meshlet> *mMeshlets;
+    unsigned mActive; // chunks the job is split in
+    float mPlanes[6][4];
+    float mEye[3];
+
+    std::vector<Chunk> mChunks;
+
+    std::vector<GLuint> mFirst;
+    std::vector<GLsizei> mCounts;
+    Statistics mStatistics;
+  };
+}
+
+#endif
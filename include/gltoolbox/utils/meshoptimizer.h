@@ -0,0 +1,58 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_MESHOPTIMIZER_H__
+#define __GLTOOLBOX_MESHOPTIMIZER_H__
+
+#include <vector>
+
+#include <gltoolbox/gl.h>
+
+namespace gltoolbox
+{
+  // cpu stages run on triangle lists before upload.
+  // vertices are raw structures of stride bytes, indices are 32 bits.
+
+  //vertices with identical bytes get the same remap value (index of the first of them).
+  //returns the number of unique vertices
+  GLsizei weld_vertices(const void *vertices, GLsizei numvertices, GLsizei stride, std::vector<GLuint> &remap);
+
+  //reorder triangles for post-transform cache reuse (tipsify, Sander et al. 2007)
+  void optimize_vertex_cache(GLuint *indices, GLsizei count, GLsizei numvertices, GLsizei cachesize = 16);
+
+  //renumber vertices in order of first use and move their data accordingly.
+  //unreferenced vertices are dropped, returns the new number of vertices
+  GLsizei optimize_vertex_fetch(void *vertices, GLsizei numvertices, GLsizei stride, GLuint *indices, GLsizei count);
+
+  //average number of vertex shader invocations per triangle with a fifo cache
+  float average_cache_miss_ratio(const GLuint *indices, GLsizei count, GLsizei numvertices, GLsizei cachesize = 16);
+
+  //weld, cache and fetch optimization in one go, vertices is shrunk to the unique vertices.
+  //returns the number of vertices
+  GLsizei optimize_mesh(std::vector<char> &vertices, GLsizei stride, std::vector<GLuint> &indices, GLsizei cachesize = 16);
+}
+
+#endif
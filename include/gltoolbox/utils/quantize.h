@@ -0,0 +1,81 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_QUANTIZE_H__
+#define __GLTOOLBOX_QUANTIZE_H__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gltoolbox/vertexarray.h>
+
+namespace gltoolbox
+{
+  //=====================================================
+  // scalar conversions
+  //=====================================================
+
+  uint16_t float_to_half(float value); // round to nearest even
+  float half_to_float(uint16_t value);
+
+  int16_t float_to_snorm16(float value); // clamped to [-1, 1]
+
+  //GL_INT_2_10_10_10_REV with normalized = GL_TRUE, x in the low bits
+  uint32_t pack_snorm_2_10_10_10(float x, float y, float z, float w = 0.f);
+
+  //=====================================================
+  // array conversions, vectorized when the target allows it.
+  // quantize_half uses F16C when the cpu has it (checked at runtime with gcc and clang).
+  // results match the scalar conversions except for nan payloads, kept by F16C
+  //=====================================================
+
+  void quantize_half(const float *src, uint16_t *dst, size_t count);
+  void quantize_snorm16(const float *src, int16_t *dst, size_t count);
+  void quantize_normals(const float *src, uint32_t *dst, size_t count); // count xyz triplets
+
+  //=====================================================
+  // packed attributes
+  //=====================================================
+
+  // attribute data with the format matching its packing
+  struct PackedAttribute
+  {
+    std::vector<char> data;
+    GLsizei count;
+    VertexArray::AttributeFormat format;
+  };
+
+  //count vertices of size components, 3 component attributes are padded to 4 to keep 4 byte alignment
+  PackedAttribute pack_half(const float *src, GLsizei count, GLint size);
+  PackedAttribute pack_snorm16(const float *src, GLsizei count, GLint size);
+  PackedAttribute pack_normals(const float *src, GLsizei count);
+
+  bool add_packed_attribute(VertexArray &vao, const std::string &name, const PackedAttribute &attribute,
+                            GLenum usage = GL_STATIC_DRAW, GLuint divisor = 0);
+}
+
+#endif
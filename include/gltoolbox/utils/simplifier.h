@@ -0,0 +1,64 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_SIMPLIFIER_H__
+#define __GLTOOLBOX_SIMPLIFIER_H__
+
+#include <vector>
+
+#include <gltoolbox/gl.h>
+
+namespace gltoolbox
+{
+  // level of detail stored in a shared index buffer, drawn with
+  // VertexArray::draw_sub_elements(firstIndex, count)
+  struct MeshLod
+  {
+    GLuint firstIndex;
+    GLsizei count;
+    float error; // largest geometric deviation from the full mesh, in object units
+  };
+
+  //quadric error edge collapse on a welded triangle list. vertices are kept in place and the
+  //result indexes the same vertex buffer; positions are 3 floats at the start of each vertex.
+  //stops at targetcount indices or when the next collapse deviates more than maxerror.
+  //border vertices are never removed. error receives the deviation of the result
+  std::vector<GLuint> simplify(const GLuint *indices, GLsizei count,
+                               const float *positions, GLsizei numvertices, GLsizei stride,
+                               GLsizei targetcount, float maxerror = 1e30f, float *error = nullptr);
+
+  //chain of at most levels lods, each one with about ratio times the indices of the previous.
+  //all lods are appended to lodindices, lod 0 being the input mesh
+  std::vector<MeshLod> build_lods(const std::vector<GLuint> &indices,
+                                  const float *positions, GLsizei numvertices, GLsizei stride,
+                                  std::vector<GLuint> &lodindices, GLsizei levels = 5, float ratio = 0.5f);
+
+  //coarsest lod whose error projects to at most pixelerror pixels for an object at distance
+  //seen with a vertical field of view fovy (radians) in a viewport of height pixels
+  size_t select_lod(const std::vector<MeshLod> &lods, float distance, float fovy, float height, float pixelerror = 1.f);
+}
+
+#endif
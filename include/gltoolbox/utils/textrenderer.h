@@ -32,6 +32,7 @@
 #include <vector>
 
 #include <gltoolbox/program.h>
+#include <gltoolbox/instancestream.h>
 #include <gltoolbox/texture.h>
 #include <gltoolbox/vertexarray.h>
 
@@ -62,7 +63,8 @@ namespace gltoolbox
     static int padding;
 
   public:
-    TextRenderer(bool doInit = false);
+    //when a cache is given the program binary is loaded from / stored into it
+    TextRenderer(bool doInit = false, ProgramCache *cache = nullptr);
     virtual ~TextRenderer();
 
     inline void set_font_size(float size) { mCurrSize = size; }
@@ -114,6 +116,13 @@ namespace gltoolbox
 
     void draw(const std::string &text, float x, float y, const std::string &fontname, const float &size, const std::array<float, 3> &color);
 
+    //release the glyphs of this frame to the gpu, call once per frame after the last draw
+    inline void end_frame()
+    {
+      if (mGlyphs)
+        mGlyphs->end_frame();
+    }
+
     //load font data from .ttf file, sets loaded font to current
     bool load_font(const std::string &filename, unsigned int size = 48);
 
@@ -129,12 +138,17 @@ namespace gltoolbox
     //font database
     std::unordered_map<std::string, Font> mFonts;
 
-    //geometry
-    std::vector<float> mPos;
-    std::vector<float> mTex;
+    //geometry, one instance per glyph streamed into mapped memory
+    struct Glyph
+    {
+      float pos[4];
+      float tex[4];
+    };
+    std::shared_ptr<InstanceStream<Glyph>> mGlyphs;
 
     //rendering
     bool mIsInit;
+    ProgramCache *mCache;
     Texture mAtlas;
     mutable Program mPrg;
     mutable VertexArray mVao;
@@ -29,11 +29,15 @@
 
 #include "gl.h"
 #include "buffer.h"
+#include "bufferarena.h"
+#include "vertexlayout.h"
 
 #include <unordered_map>
 
 namespace gltoolbox
 {
+  class Program;
+
   class VertexArray
   {
     //=====================================================
@@ -47,12 +51,14 @@ namespace gltoolbox
       GLboolean normalized;
       GLsizei stride;
       GLuint offset;
+      bool integer = false; // read as int/uint in the shader instead of being converted to float
     };
 
   protected:
     struct IndexBuffer
     {
       std::shared_ptr<Buffer> buffer;
+      BufferRange range; // set when the indices live in a BufferArena
       GLsizei count;
       GLenum mode;
       GLenum type;
@@ -61,11 +67,37 @@ namespace gltoolbox
     struct AttributeBuffer
     {
       std::shared_ptr<Buffer> buffer;
+      BufferRange range; // set when the data lives in a BufferArena
       AttributeFormat format;
       GLuint count;
       GLuint divisor;
     };
 
+    // vertex buffer binding recorded in the vertex array object
+    struct AttributeBinding
+    {
+      GLuint index;
+      const AttributeBuffer *attribute;
+      GLsizei stride;
+      size_t generation; // buffer generation last given to the vao
+      GLintptr offset; // offset last given to the vao
+    };
+
+    // attribute paired with a shader location, resolved once so drawing does no name lookup
+    struct ResolvedAttribute
+    {
+      GLuint location;
+      const AttributeBuffer *attribute;
+    };
+
+    // dense binding table of a program paired with this vertex array
+    struct BindingTable
+    {
+      std::unordered_map<std::string, GLint> locations; // names as given by the program
+      std::vector<ResolvedAttribute> attributes;        // sorted by location
+      size_t revision = 0;                              // attributes revision it was resolved against
+    };
+
   public:
     //=====================================================
     // Initialisation
@@ -88,7 +120,9 @@ namespace gltoolbox
     //=====================================================
     // bind/unbind
     //=====================================================
-    inline void bind() const { glBindVertexArray(mId); }
+    // binding is all a draw needs once the attributes are enabled,
+    // buffers that changed since (reallocation, defragmentation) are re-attached here
+    void bind() const;
     inline void unbind() const { glBindVertexArray(0); }
 
     //=====================================================
@@ -101,6 +135,28 @@ namespace gltoolbox
     void draw_elements(GLsizei inum) const;
     void draw_elements(GLuint start, GLuint end) const;
 
+    void draw_elements_base_vertex(GLuint start, GLuint end, GLint basevertex) const;
+    void draw_elements_base_instance(GLsizei inum, GLuint baseinstance) const;
+
+    // count indices from firstindex, added to basevertex. used to draw one mesh of a shared buffer
+    void draw_sub_elements(GLuint firstindex, GLsizei count, GLint basevertex = 0) const;
+    // one draw per index range, in a single call
+    void multi_draw_sub_elements(const GLuint *firstindices, const GLsizei *counts, GLsizei drawcount) const;
+    // one draw per entry, offsets are byte offsets in the index buffer
+    void multi_draw_elements_base_vertex(const GLsizei *counts, const GLvoid *const *offsets,
+                                         const GLint *basevertices, GLsizei drawcount) const;
+
+    // drawcount commands read from a GL_DRAW_INDIRECT_BUFFER starting at command first,
+    // the stride is the element size of the buffer (see IndirectCommandBuffer).
+    // firstIndex of the commands is relative to the index buffer, not to its arena range
+    void multi_draw_elements_indirect(const Buffer &commands, GLsizei drawcount, GLsizei first = 0) const;
+    void multi_draw_arrays_indirect(GLenum mode, const Buffer &commands, GLsizei drawcount, GLsizei first = 0) const;
+
+    // the number of commands is read by the gpu from a GLuint at countoffset in drawcount (GL 4.6),
+    // e.g. written by a culling compute shader
+    void multi_draw_elements_indirect_count(const Buffer &commands, const Buffer &drawcount, GLsizei maxdrawcount,
+                                            GLintptr countoffset = 0) const;
+
     //=====================================================
     // Index Buffer
     //=====================================================
@@ -111,6 +167,7 @@ namespace gltoolbox
     {
       mIndices.buffer.reset(new Buffer(GL_ELEMENT_ARRAY_BUFFER, sizeof(T), usage));
       mIndices.buffer->upload(indices, count);
+      mIndices.range = BufferRange();
 
       mIndices.count = count;
       mIndices.mode = mode;
@@ -129,6 +186,19 @@ namespace gltoolbox
       }
     }
 
+    // 32 bit indices stored with the smallest type able to address numvertices
+    void set_narrowed_index_buffer(GLenum mode, const GLuint *indices, GLsizei count, GLsizei numvertices,
+                                   GLenum usage = GL_STATIC_DRAW);
+
+    // smallest index type able to address numvertices: GL_UNSIGNED_{BYTE|SHORT|INT}
+    static GLenum index_type(GLsizei numvertices);
+
+    // use an existing index buffer, it can be shared with other vertex arrays
+    void set_index_buffer(GLenum mode, const std::shared_ptr<Buffer> &buffer, GLsizei count, GLenum type);
+
+    // indices stored in a range of a BufferArena, type is one of GL_UNSIGNED_{BYTE|SHORT|INT}
+    void set_index_buffer(GLenum mode, const BufferRange &range, GLsizei count, GLenum type);
+
     inline const std::shared_ptr<Buffer> &index_buffer() const
     {
       return mIndices.buffer;
@@ -154,17 +224,40 @@ namespace gltoolbox
         attr.buffer.reset(new Buffer(GL_ARRAY_BUFFER, sizeof(T), usage)); //, data, count, usage));
         attr.buffer->upload(data, count);
 
-        attr.format = {size, type, stride, offset};
+        attr.format = {size, type, normalized, stride, GLuint(offset)};
         attr.count = count;
         attr.divisor = divisor;
 
         mAttributes.insert({name, std::move(attr)});
+        ++mRevision;
 
         return true;
       }
       return false;
     }
 
+    // use an existing buffer as attribute source, the buffer can be shared with other vertex arrays
+    bool add_attribute(const std::string &name, const std::shared_ptr<Buffer> &buffer, GLsizei count,
+                       GLsizei size, GLenum type, GLsizei stride, GLsizei offset,
+                       GLboolean normalized = GL_FALSE, GLuint divisor = 0);
+
+    // attribute data stored in a range of a BufferArena
+    bool add_attribute(const std::string &name, const BufferRange &range, GLsizei count,
+                       GLsizei size, GLenum type, GLsizei stride, GLsizei offset,
+                       GLboolean normalized = GL_FALSE, GLuint divisor = 0);
+
+    // interleaved attributes described by layout, all read from one buffer
+    template <typename V>
+    bool add_vertices(const VertexLayout &layout, V *vertices, GLsizei count,
+                      GLenum usage = GL_STATIC_DRAW, GLuint divisor = 0)
+    {
+      auto buffer = std::make_shared<Buffer>(GL_ARRAY_BUFFER, sizeof(V), usage);
+      buffer->upload(vertices, count);
+      return add_vertices(layout, buffer, count, divisor);
+    }
+
+    bool add_vertices(const VertexLayout &layout, const std::shared_ptr<Buffer> &buffer, GLsizei count, GLuint divisor = 0);
+
     void remove_attribute(const std::string &name)
     {
       auto search = mAttributes.find(name);
@@ -173,6 +266,7 @@ namespace gltoolbox
         //delete the buffer
         mAttributes[name].buffer.reset();
         mAttributes.erase(name);
+        ++mRevision;
       }
     }
 
@@ -186,24 +280,43 @@ namespace gltoolbox
       return mAttributes.at(name).format;
     }
 
-    inline AttributeFormat &attribute_format(const std::string &name)
+    inline const GLuint &attribute_divisor(const std::string &name) const
     {
-      return mAttributes.at(name).format;
+      return mAttributes.at(name).divisor;
     }
 
-    inline const GLuint &attribute_divisor(const std::string &name) const
+    // changing the format or divisor records the vertex format again on the next pairing
+    bool set_attribute_format(const std::string &name, const AttributeFormat &format)
     {
-      return mAttributes.at(name).divisor;
+      auto search = mAttributes.find(name);
+      if (search == mAttributes.end())
+        return false;
+
+      search->second.format = format;
+      ++mRevision;
+      return true;
     }
 
-    inline GLuint &attribute_divisor(const std::string &name)
+    bool set_attribute_divisor(const std::string &name, GLuint divisor)
     {
-      return mAttributes.at(name).divisor;
+      auto search = mAttributes.find(name);
+      if (search == mAttributes.end())
+        return false;
+
+      search->second.divisor = divisor;
+      ++mRevision;
+      return true;
     }
 
+    // pair the attributes with shader locations, the vertex format is recorded once in the vao.
+    // calling it again with the same map is a no-op
     void enable_attribute(const std::string &name, GLint loc) const;
     void enable_attributes(const std::unordered_map<std::string, GLint> &attributes) const;
 
+    // pair with the attributes of a program, the binding table is resolved once per program
+    // and switching between programs only compares generations
+    void enable_attributes(const Program &program) const;
+
     void disable_attribute(const std::string &name, GLint loc) const;
     void disable_attributes(const std::unordered_map<std::string, GLint> &attributes) const;
 
@@ -211,6 +324,21 @@ namespace gltoolbox
     void create();
     void destroy();
 
+    // resolve the names of a binding table against the attributes
+    void resolve(BindingTable &table) const;
+
+    // record format, binding and divisor of the table attributes and make it current
+    void record_format(BindingTable &table) const;
+
+    // offsets within the stride are relative offsets of interleaved attributes, larger ones
+    // locate a planar attribute in a shared buffer and go into the binding offset since the
+    // relative offset is limited to GL_MAX_VERTEX_ATTRIB_RELATIVE_OFFSET (2047 at least)
+    static inline bool is_relative_offset(const AttributeFormat &format, GLsizei stride) { return GLsizei(format.offset) < stride; }
+    static GLintptr binding_offset(const AttributeBuffer &attr, GLsizei stride);
+
+    // byte offset of the indices in the bound index buffer
+    inline GLintptr index_offset() const { return mIndices.range.is_valid() ? mIndices.range.offset() : 0; }
+
   protected:
     GLuint mId;
     bool mOwned;
@@ -220,6 +348,22 @@ namespace gltoolbox
 
     // vertex attribute buffers
     std::unordered_map<std::string, AttributeBuffer> mAttributes;
+
+    // bumped whenever an attribute is added, removed or its format changes
+    size_t mRevision;
+
+    // binding tables keyed by program generation, 0 holds pairings given by name
+    mutable std::unordered_map<size_t, BindingTable> mTables;
+    mutable BindingTable *mCurrent;
+    mutable const void *mPairedWith;
+
+    // recorded vertex format
+    mutable std::vector<AttributeBinding> mBindings;
+    mutable std::vector<GLuint> mEnabled;
+    mutable size_t mBoundIndices; // generation of the index buffer given to the vao
+
+    // scratch byte offsets of multi_draw_sub_elements
+    mutable std::vector<const GLvoid *> mOffsets;
   };
 }
 
@@ -0,0 +1,159 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_VERTEXLAYOUT_H__
+#define __GLTOOLBOX_VERTEXLAYOUT_H__
+
+#include "gl.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace gltoolbox
+{
+  // description of the attributes interleaved in one vertex structure.
+  // e.g. for struct Vertex { float pos[3]; uint8_t rgba[4]; }
+  //   VertexLayout layout(sizeof(Vertex));
+  //   layout.add<float>("vPos", 3, offsetof(Vertex, pos)).add<uint8_t>("vCol", 4, offsetof(Vertex, rgba), GL_TRUE);
+  class VertexLayout
+  {
+  public:
+    struct Attribute
+    {
+      std::string name;
+      GLint size;
+      GLenum type;
+      GLboolean normalized;
+      GLuint offset;
+      bool integer;
+    };
+
+  public:
+    template <typename T>
+    static GLenum type_of()
+    {
+      if constexpr (std::is_same_v<T, float>)
+        return GL_FLOAT;
+      else if constexpr (std::is_same_v<T, double>)
+        return GL_DOUBLE;
+      else if constexpr (std::is_same_v<T, int32_t>)
+        return GL_INT;
+      else if constexpr (std::is_same_v<T, uint32_t>)
+        return GL_UNSIGNED_INT;
+      else if constexpr (std::is_same_v<T, int16_t>)
+        return GL_SHORT;
+      else if constexpr (std::is_same_v<T, uint16_t>)
+        return GL_UNSIGNED_SHORT;
+      else if constexpr (std::is_same_v<T, int8_t>)
+        return GL_BYTE;
+      else
+      {
+        static_assert(std::is_same_v<T, uint8_t>, "unsupported vertex attribute type");
+        return GL_UNSIGNED_BYTE;
+      }
+    }
+
+  public:
+    // stride = 0 packs the attributes tightly
+    VertexLayout(GLsizei stride = 0) : mStride(stride), mEnd(0) {}
+
+    inline GLsizei stride() const { return (mStride > 0) ? mStride : mEnd; }
+    inline const std::vector<Attribute> &attributes() const { return mAttributes; }
+
+    // attribute at an explicit offset in the vertex (see offsetof)
+    VertexLayout &add(const std::string &name, GLint size, GLenum type, GLuint offset, GLboolean normalized = GL_FALSE)
+    {
+      mAttributes.push_back({name, size, type, normalized, offset, false});
+      mEnd = std::max(mEnd, GLsizei(offset + attribute_size(size, type)));
+      return *this;
+    }
+
+    // attribute placed right after the previous one
+    VertexLayout &append(const std::string &name, GLint size, GLenum type, GLboolean normalized = GL_FALSE)
+    {
+      return add(name, size, type, mEnd, normalized);
+    }
+
+    // integer attribute read as int/uint vectors in the shader
+    VertexLayout &add_integer(const std::string &name, GLint size, GLenum type, GLuint offset)
+    {
+      add(name, size, type, offset);
+      mAttributes.back().integer = true;
+      return *this;
+    }
+
+    VertexLayout &append_integer(const std::string &name, GLint size, GLenum type)
+    {
+      return add_integer(name, size, type, mEnd);
+    }
+
+    template <typename T>
+    inline VertexLayout &add(const std::string &name, GLint size, GLuint offset, GLboolean normalized = GL_FALSE)
+    {
+      return add(name, size, type_of<T>(), offset, normalized);
+    }
+
+    template <typename T>
+    inline VertexLayout &append(const std::string &name, GLint size, GLboolean normalized = GL_FALSE)
+    {
+      return append(name, size, type_of<T>(), normalized);
+    }
+
+  public:
+    // size in bytes of one attribute value
+    static GLsizei attribute_size(GLint size, GLenum type)
+    {
+      switch (type)
+      {
+      case GL_BYTE:
+      case GL_UNSIGNED_BYTE:
+        return size;
+      case GL_SHORT:
+      case GL_UNSIGNED_SHORT:
+      case GL_HALF_FLOAT:
+        return 2 * size;
+      case GL_DOUBLE:
+        return 8 * size;
+      case GL_INT_2_10_10_10_REV:
+      case GL_UNSIGNED_INT_2_10_10_10_REV:
+      case GL_UNSIGNED_INT_10F_11F_11F_REV:
+        return 4;
+      default:
+        return 4 * size;
+      }
+    }
+
+  protected:
+    GLsizei mStride;
+    GLsizei mEnd;
+    std::vector<Attribute> mAttributes;
+  };
+}
+
+#endif
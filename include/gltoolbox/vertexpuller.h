@@ -0,0 +1,118 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#ifndef __GLTOOLBOX_VERTEXPULLER_H__
+#define __GLTOOLBOX_VERTEXPULLER_H__
+
+#include "gl.h"
+#include "buffer.h"
+#include "vertexarray.h"
+#include "vertexlayout.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gltoolbox
+{
+  // programmable vertex pulling: vertex and index data are read from shader storage buffers
+  // by functions generated from the layouts, every draw goes through the same empty vertex array.
+  // the base vertex travels in the base instance of the draw (gl_BaseInstanceARB), so meshes with
+  // different layouts and offsets are drawn without any vertex array change.
+  //
+  // in the vertex shader, after #version:
+  //   <shader_source()>
+  //   void main() { uint v = gltb_vertex(); vec3 p = fetch_vPos(v); ... }
+  class VertexPuller
+  {
+  protected:
+    struct Stream
+    {
+      GLuint binding;
+      VertexLayout layout;
+      std::shared_ptr<Buffer> buffer;
+    };
+
+  public:
+    VertexPuller();
+
+    VertexPuller(const VertexPuller &other) = delete;
+    VertexPuller(VertexPuller &&temp) = delete;
+
+    virtual ~VertexPuller();
+
+    VertexPuller &operator=(const VertexPuller &other) = delete;
+
+    //=====================================================
+    // Data
+    //=====================================================
+
+    //vertices of layout read from buffer bound at the shader storage binding point.
+    //offsets and stride must be multiples of the component size, the buffer size a multiple of 4 bytes.
+    //fails when an attribute type cannot be fetched (GL_DOUBLE, GL_FIXED) or the binding is already used
+    bool add_stream(GLuint binding, const VertexLayout &layout, const std::shared_ptr<Buffer> &buffer);
+
+    //indices of type GL_UNSIGNED_{BYTE|SHORT|INT}, without index buffer vertices are read in order.
+    //fails when the binding is used by a stream
+    bool set_index_buffer(GLuint binding, const std::shared_ptr<Buffer> &buffer, GLenum type);
+
+    inline bool has_index_buffer() const { return mIndices != nullptr; }
+
+    //glsl declarations of the buffers and fetch functions
+    std::string shader_source() const;
+
+    //=====================================================
+    // Drawing
+    //=====================================================
+
+    //bind the empty vertex array and the storage buffers
+    void bind() const;
+    inline void unbind() const { mVao.unbind(); }
+
+    //count vertices (or indices) from first, basevertex is added to the fetched indices
+    void draw(GLenum mode, GLuint first, GLsizei count, GLint basevertex = 0) const;
+
+    //DrawArraysIndirectCommand records, first is the first index and baseInstance the base vertex
+    void multi_draw_indirect(GLenum mode, const Buffer &commands, GLsizei drawcount, GLsizei first = 0) const;
+
+  protected:
+    static bool is_supported(GLenum type);
+    bool is_bound(GLuint binding) const;
+
+    static std::string fetch_function(const Stream &stream, const VertexLayout::Attribute &attribute);
+
+  protected:
+    VertexArray mVao;
+
+    std::vector<Stream> mStreams;
+
+    GLuint mIndexBinding;
+    GLenum mIndexType;
+    std::shared_ptr<Buffer> mIndices;
+  };
+}
+
+#endif
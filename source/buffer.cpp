@@ -28,8 +28,11 @@
 
 using namespace gltoolbox;
 
+static std::atomic<size_t> generations(0);
+
 Buffer::Buffer(GLenum target, GLsizei elementsize, GLenum usage)
-    : mId(0), mOwned(false), mUsage(usage), mTarget(target), mElementSize(elementsize)
+    : mId(0), mOwned(false), mGeneration(0), mUsage(usage), mTarget(target), mElementSize(elementsize),
+      mSize(0), mImmutable(false), mStorageFlags(GL_NONE_BIT)
 {
   create();
 }
@@ -42,13 +45,19 @@ Buffer::Buffer(Buffer &&temp)
   //move buffer ownership
   mId = temp.mId;
   mOwned = temp.mOwned;
+  mGeneration = temp.mGeneration;
 
   mUsage = temp.mUsage;
   mTarget = temp.mTarget;
   mElementSize = temp.mElementSize;
 
+  mSize = temp.mSize;
+  mImmutable = temp.mImmutable;
+  mStorageFlags = temp.mStorageFlags;
+
   temp.mId = 0;
   temp.mOwned = false;
+  temp.mSize = 0;
 }
 
 Buffer::~Buffer()
@@ -64,47 +73,102 @@ Buffer &Buffer::operator=(Buffer &other)
   //move buffer ownership
   mId = other.mId;
   mOwned = other.mOwned;
+  mGeneration = other.mGeneration;
 
   mUsage = other.mUsage;
   mTarget = other.mTarget;
   mElementSize = other.mElementSize;
 
+  mSize = other.mSize;
+  mImmutable = other.mImmutable;
+  mStorageFlags = other.mStorageFlags;
+
   other.mId = 0;
   other.mOwned = false;
+  other.mSize = 0;
 
   return *this;
 }
 
-void Buffer::upload(void *ptr, GLsizei count) const
+void Buffer::allocate_storage(GLsizei count, BufferStorageMask flags, void *ptr)
+{
+  //immutable storage cannot be re-specified, a new buffer object is needed
+  if (mImmutable)
+  {
+    destroy();
+    create();
+  }
+
+  mSize = GLsizeiptr(count) * element_size();
+  mImmutable = true;
+  mStorageFlags = flags;
+  glNamedBufferStorage(id(), mSize, ptr, flags);
+}
+
+void Buffer::upload(void *ptr, GLsizei count)
 {
-  bind();
-  glBufferData(target(), count * element_size(), ptr, usage());
+  GLsizeiptr size = GLsizeiptr(count) * element_size();
+
+  //update in place when the data fits
+  if (size <= mSize && (!mImmutable || (mStorageFlags & GL_DYNAMIC_STORAGE_BIT) == GL_DYNAMIC_STORAGE_BIT))
+  {
+    glNamedBufferSubData(id(), 0, size, ptr);
+    return;
+  }
+
+  if (mImmutable)
+  {
+    allocate_storage(count, mStorageFlags | GL_DYNAMIC_STORAGE_BIT, ptr);
+    return;
+  }
+
+  glNamedBufferData(id(), size, ptr, usage());
+  mSize = size;
 }
 
 void Buffer::upload(void *ptr, GLsizei offset, GLsizei count) const
 {
-  bind();
-  glBufferSubData(target(), offset * element_size(), count * element_size(), ptr);
+  glNamedBufferSubData(id(), GLintptr(offset) * element_size(), GLsizeiptr(count) * element_size(), ptr);
 }
 
 void Buffer::download(void *ptr, GLsizei size) const
 {
-  bind();
-  glGetBufferSubData(target(), 0, size, ptr);
+  glGetNamedBufferSubData(id(), 0, size, ptr);
 }
 
 void Buffer::download(void *ptr, GLsizei offset, GLsizei size) const
 {
-  bind();
-  glGetBufferSubData(target(), offset, size, ptr);
+  glGetNamedBufferSubData(id(), offset, size, ptr);
+}
+
+void *Buffer::map(GLsizei offset, GLsizei count, MapBufferAccessMask access) const
+{
+  return glMapNamedBufferRange(id(), GLintptr(offset) * element_size(), GLsizeiptr(count) * element_size(), access);
+}
+
+void Buffer::flush_mapped(GLsizei offset, GLsizei count) const
+{
+  glFlushMappedNamedBufferRange(id(), GLintptr(offset) * element_size(), GLsizeiptr(count) * element_size());
+}
+
+bool Buffer::unmap() const
+{
+  return glUnmapNamedBuffer(id()) == GL_TRUE;
+}
+
+Readback Buffer::download_async(GLintptr offset, GLsizeiptr size) const
+{
+  return Readback(*this, offset, size);
 }
 
 void Buffer::create()
 {
   if (!mOwned || !is_valid())
   {
-    glCreateBuffers(1, &mId);
-    bind(); // this will actually trigger the buffer creation
+    glCreateBuffers(1, &mId); // buffer object is created without binding it
+    mGeneration = ++generations;
+    mSize = 0;
+    mImmutable = false;
     mOwned = true;
   }
 }
@@ -122,7 +186,6 @@ void Buffer::destroy()
 GLint Buffer::get_parameter(const GLenum param) const
 {
   GLint result;
-  bind();
-  glGetBufferParameteriv(target(), param, &result);
+  glGetNamedBufferParameteriv(id(), param, &result);
   return result;
 }
\ No newline at end of file
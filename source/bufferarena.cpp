@@ -0,0 +1,252 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/bufferarena.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <limits>
+
+//=====================================================
+// BufferRange
+//=====================================================
+
+void BufferRange::upload(const void *ptr, GLsizeiptr size, GLintptr offset) const
+{
+  mAlloc->buffer->upload(const_cast<void *>(ptr), GLsizei(mAlloc->offset + offset), GLsizei(size));
+}
+
+void BufferRange::download(void *ptr, GLsizeiptr size, GLintptr offset) const
+{
+  mAlloc->buffer->download(ptr, GLsizei(mAlloc->offset + offset), GLsizei(size));
+}
+
+//=====================================================
+// BufferArena
+//=====================================================
+
+BufferArena::BufferArena(GLenum target, GLsizeiptr blocksize, GLsizeiptr alignment)
+    : mTarget(target), mBlockSize(blocksize), mAlignment(std::max(alignment, GLsizeiptr(1)))
+{
+}
+
+BufferArena::~BufferArena()
+{
+}
+
+BufferRange BufferArena::allocate(GLsizeiptr size)
+{
+  GLsizeiptr need = std::max(GLsizeiptr(1), (size + mAlignment - 1) / mAlignment) * mAlignment;
+
+  //best fit over all blocks
+  GLuint index = std::numeric_limits<GLuint>::max();
+  GLintptr offset = 0;
+  GLsizeiptr available = std::numeric_limits<GLsizeiptr>::max();
+  for (GLuint i = 0; i < mBlocks.size(); ++i)
+  {
+    auto search = mBlocks[i].freeBySize.lower_bound(need);
+    if (search != mBlocks[i].freeBySize.end() && search->first < available)
+    {
+      index = i;
+      available = search->first;
+      offset = search->second;
+    }
+  }
+
+  if (index == std::numeric_limits<GLuint>::max())
+  {
+    index = add_block(std::max(mBlockSize, need));
+    offset = 0;
+    available = mBlocks[index].size;
+  }
+
+  Block &block = mBlocks[index];
+  erase_free(block, offset, available);
+  if (available > need)
+    insert_free(block, offset + need, available - need);
+
+  BufferRange range;
+  range.mAlloc = std::make_shared<BufferRange::Allocation>();
+  range.mAlloc->buffer = block.buffer;
+  range.mAlloc->offset = offset;
+  range.mAlloc->size = need;
+  range.mAlloc->block = index;
+  block.usedRanges[offset] = range.mAlloc;
+
+  return range;
+}
+
+BufferRange BufferArena::allocate(const void *ptr, GLsizeiptr size)
+{
+  BufferRange range = allocate(size);
+  range.upload(ptr, size);
+  return range;
+}
+
+void BufferArena::free(BufferRange &range)
+{
+  if (!range.is_valid())
+    return;
+
+  std::shared_ptr<BufferRange::Allocation> alloc = std::move(range.mAlloc);
+  Block &block = mBlocks[alloc->block];
+
+  block.usedRanges.erase(alloc->offset);
+  insert_free(block, alloc->offset, alloc->size);
+
+  //invalidate every copy of the handle
+  alloc->buffer.reset();
+}
+
+void BufferArena::defragment()
+{
+  std::vector<Block> blocks;
+  blocks.reserve(mBlocks.size());
+
+  for (auto &block : mBlocks)
+  {
+    //release empty blocks
+    if (block.usedRanges.empty())
+      continue;
+
+    GLuint index = GLuint(blocks.size());
+    bool packed = block.freeRanges.empty() ||
+                  (block.freeRanges.size() == 1 && block.freeRanges.begin()->first + block.freeRanges.begin()->second == block.size);
+
+    if (!packed)
+    {
+      //copy every range in a fresh buffer (copies within one buffer cannot overlap)
+      Buffer compact(mTarget, 1);
+      compact.allocate_storage(GLsizei(block.size), GL_DYNAMIC_STORAGE_BIT);
+
+      GLintptr cursor = 0;
+      std::map<GLintptr, std::shared_ptr<BufferRange::Allocation>> used;
+      for (auto &[offset, alloc] : block.usedRanges)
+      {
+        glCopyNamedBufferSubData(block.buffer->id(), compact.id(), offset, cursor, alloc->size);
+        alloc->offset = cursor;
+        used[cursor] = alloc;
+        cursor += alloc->size;
+      }
+
+      //keep the same Buffer object so that handles and vertex arrays stay valid
+      *block.buffer = compact;
+      block.usedRanges = std::move(used);
+      block.freeRanges.clear();
+      block.freeBySize.clear();
+      if (cursor < block.size)
+        insert_free(block, cursor, block.size - cursor);
+    }
+
+    for (auto &[offset, alloc] : block.usedRanges)
+      alloc->block = index;
+
+    blocks.push_back(std::move(block));
+  }
+
+  mBlocks = std::move(blocks);
+}
+
+BufferArena::Statistics BufferArena::statistics() const
+{
+  Statistics stats = {0, 0, 0, 0, mBlocks.size(), 0, 0, 0.f};
+
+  for (const auto &block : mBlocks)
+  {
+    stats.reserved += block.size;
+    stats.numRanges += block.usedRanges.size();
+    stats.numFreeRanges += block.freeRanges.size();
+
+    for (const auto &[offset, size] : block.freeRanges)
+    {
+      stats.free += size;
+      stats.largest = std::max(stats.largest, size);
+    }
+  }
+
+  stats.used = stats.reserved - stats.free;
+  if (stats.free > 0)
+    stats.fragmentation = 1.f - float(stats.largest) / float(stats.free);
+
+  return stats;
+}
+
+GLuint BufferArena::add_block(GLsizeiptr size)
+{
+  Block block;
+  block.buffer = std::make_shared<Buffer>(mTarget, 1);
+  block.buffer->allocate_storage(GLsizei(size), GL_DYNAMIC_STORAGE_BIT);
+  block.size = size;
+  insert_free(block, 0, size);
+
+  mBlocks.push_back(std::move(block));
+  return GLuint(mBlocks.size() - 1);
+}
+
+void BufferArena::insert_free(Block &block, GLintptr offset, GLsizeiptr size)
+{
+  //merge with the following free range
+  auto next = block.freeRanges.find(offset + size);
+  if (next != block.freeRanges.end())
+  {
+    GLsizeiptr nextsize = next->second;
+    erase_free(block, offset + size, nextsize);
+    size += nextsize;
+  }
+
+  //merge with the preceding free range
+  auto prev = block.freeRanges.lower_bound(offset);
+  if (prev != block.freeRanges.begin())
+  {
+    --prev;
+    if (prev->first + prev->second == offset)
+    {
+      GLintptr prevoffset = prev->first;
+      GLsizeiptr prevsize = prev->second;
+      erase_free(block, prevoffset, prevsize);
+      offset = prevoffset;
+      size += prevsize;
+    }
+  }
+
+  block.freeRanges[offset] = size;
+  block.freeBySize.insert({size, offset});
+}
+
+void BufferArena::erase_free(Block &block, GLintptr offset, GLsizeiptr size)
+{
+  block.freeRanges.erase(offset);
+
+  auto range = block.freeBySize.equal_range(size);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (it->second == offset)
+    {
+      block.freeBySize.erase(it);
+      break;
+    }
+  }
+}
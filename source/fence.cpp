@@ -0,0 +1,101 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/fence.h>
+using namespace gltoolbox;
+
+Fence::Fence()
+    : mId(nullptr)
+{
+}
+
+Fence::Fence(Fence &&temp)
+    : mId(temp.mId)
+{
+  temp.mId = nullptr;
+}
+
+Fence::~Fence()
+{
+  destroy();
+}
+
+Fence &Fence::operator=(Fence &&temp)
+{
+  destroy();
+  mId = temp.mId;
+  temp.mId = nullptr;
+  return *this;
+}
+
+void Fence::insert()
+{
+  destroy();
+  mId = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_NONE_BIT);
+}
+
+bool Fence::is_signaled()
+{
+  if (mId == nullptr)
+    return true;
+
+  GLenum result = glClientWaitSync(mId, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+  if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED)
+  {
+    destroy();
+    return true;
+  }
+
+  return false;
+}
+
+void Fence::wait()
+{
+  if (mId == nullptr)
+    return;
+
+  // 1ms steps, the first call also flushes the command stream so the fence can be reached
+  GLenum result = glClientWaitSync(mId, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+  while (result == GL_TIMEOUT_EXPIRED)
+    result = glClientWaitSync(mId, GL_NONE_BIT, 1000000);
+
+  destroy();
+}
+
+void Fence::wait_server() const
+{
+  if (mId != nullptr)
+    glWaitSync(mId, GL_NONE_BIT, GL_TIMEOUT_IGNORED);
+}
+
+void Fence::destroy()
+{
+  if (mId != nullptr)
+  {
+    glDeleteSync(mId);
+    mId = nullptr;
+  }
+}
@@ -0,0 +1,136 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/indirectcommandbuffer.h>
+using namespace gltoolbox;
+
+#include <iostream>
+
+IndirectCommandBuffer::IndirectCommandBuffer(bool indexed, GLenum usage)
+    : Buffer(GL_DRAW_INDIRECT_BUFFER,
+             indexed ? sizeof(DrawElementsIndirectCommand) : sizeof(DrawArraysIndirectCommand),
+             usage),
+      mIndexed(indexed), mDirty(false)
+{
+}
+
+IndirectCommandBuffer::~IndirectCommandBuffer()
+{
+}
+
+GLuint IndirectCommandBuffer::add_elements(GLuint count, GLuint firstindex, GLint basevertex, GLuint instancecount, GLint baseinstance)
+{
+  if (!mIndexed)
+  {
+    std::cerr << "[IndirectCommandBuffer::add_elements()] : indexed command added to an arrays command buffer" << std::endl;
+    return INVALID;
+  }
+
+  GLuint drawid = GLuint(mElements.size());
+  GLuint base = base_instance("add_elements", drawid, instancecount, baseinstance);
+  if (base == INVALID)
+    return INVALID;
+
+  mElements.push_back({count, instancecount, firstindex, basevertex, base});
+  mDirty = true;
+
+  return drawid;
+}
+
+GLuint IndirectCommandBuffer::add_arrays(GLuint count, GLuint first, GLuint instancecount, GLint baseinstance)
+{
+  if (mIndexed)
+  {
+    std::cerr << "[IndirectCommandBuffer::add_arrays()] : arrays command added to an indexed command buffer" << std::endl;
+    return INVALID;
+  }
+
+  GLuint drawid = GLuint(mArrays.size());
+  GLuint base = base_instance("add_arrays", drawid, instancecount, baseinstance);
+  if (base == INVALID)
+    return INVALID;
+
+  mArrays.push_back({count, instancecount, first, base});
+  mDirty = true;
+
+  return drawid;
+}
+
+DrawElementsIndirectCommand &IndirectCommandBuffer::elements_command(GLuint drawid)
+{
+  mDirty = true;
+  return mElements.at(drawid);
+}
+
+DrawArraysIndirectCommand &IndirectCommandBuffer::arrays_command(GLuint drawid)
+{
+  mDirty = true;
+  return mArrays.at(drawid);
+}
+
+void IndirectCommandBuffer::set_instance_count(GLuint drawid, GLuint instancecount)
+{
+  if (mIndexed)
+    mElements.at(drawid).instanceCount = instancecount;
+  else
+    mArrays.at(drawid).instanceCount = instancecount;
+  mDirty = true;
+}
+
+void IndirectCommandBuffer::clear()
+{
+  mElements.clear();
+  mArrays.clear();
+  mDirty = true;
+}
+
+GLuint IndirectCommandBuffer::base_instance(const char *caller, GLuint drawid, GLuint instancecount, GLint baseinstance) const
+{
+  if (baseinstance != DRAW_ID)
+    return GLuint(baseinstance);
+
+  if (instancecount > 1)
+  {
+    std::cerr << "[IndirectCommandBuffer::" << caller << "()] : DRAW_ID base instance with " << instancecount
+              << " instances would overlap the next draws" << std::endl;
+    return INVALID;
+  }
+
+  return drawid;
+}
+
+void IndirectCommandBuffer::commit()
+{
+  if (!mDirty)
+    return;
+
+  if (mIndexed)
+    upload(mElements.data(), GLsizei(mElements.size()));
+  else
+    upload(mArrays.data(), GLsizei(mArrays.size()));
+
+  mDirty = false;
+}
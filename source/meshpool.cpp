@@ -0,0 +1,93 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/meshpool.h>
+using namespace gltoolbox;
+
+MeshPool::MeshPool(const VertexLayout &layout, GLenum mode)
+    : mLayout(layout), mMode(mode), mVertices(GL_ARRAY_BUFFER), mIndices(GL_ELEMENT_ARRAY_BUFFER)
+{
+  mVao.add_vertices(mLayout, mVertices.buffer(), 0);
+  mVao.set_index_buffer(mMode, mIndices.buffer(), 0, GL_UNSIGNED_INT);
+}
+
+MeshPool::~MeshPool()
+{
+}
+
+GLuint MeshPool::add(const void *vertices, GLsizei numvertices, const GLuint *indices, GLsizei numindices)
+{
+  Mesh mesh;
+  mesh.baseVertex = num_vertices();
+  mesh.firstIndex = GLuint(mIndices.size());
+  mesh.count = numindices;
+  mesh.numVertices = numvertices;
+
+  // buffers grow on the gpu side, the vertex array picks up the new names when bound
+  mVertices.append(static_cast<const char *>(vertices), numvertices * mLayout.stride());
+  mIndices.append(indices, numindices);
+  mVao.set_index_buffer(mMode, mIndices.buffer(), mIndices.size(), GL_UNSIGNED_INT);
+
+  mMeshes.push_back(mesh);
+  return GLuint(mMeshes.size() - 1);
+}
+
+void MeshPool::clear()
+{
+  mVertices.clear();
+  mIndices.clear();
+  mMeshes.clear();
+  mVao.set_index_buffer(mMode, mIndices.buffer(), 0, GL_UNSIGNED_INT);
+}
+
+void MeshPool::draw(GLuint id) const
+{
+  const Mesh &mesh = mMeshes.at(id);
+  mVao.draw_sub_elements(mesh.firstIndex, mesh.count, mesh.baseVertex);
+}
+
+void MeshPool::draw(const std::vector<GLuint> &ids) const
+{
+  mCounts.resize(ids.size());
+  mOffsets.resize(ids.size());
+  mBaseVertices.resize(ids.size());
+
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    const Mesh &mesh = mMeshes.at(ids[i]);
+    mCounts[i] = mesh.count;
+    mOffsets[i] = (const GLvoid *)(GLintptr(mesh.firstIndex) * sizeof(GLuint));
+    mBaseVertices[i] = mesh.baseVertex;
+  }
+
+  mVao.multi_draw_elements_base_vertex(mCounts.data(), mOffsets.data(), mBaseVertices.data(), GLsizei(ids.size()));
+}
+
+GLuint MeshPool::add_command(IndirectCommandBuffer &commands, GLuint id, GLuint instancecount, GLint baseinstance) const
+{
+  const Mesh &mesh = mMeshes.at(id);
+  return commands.add_elements(GLuint(mesh.count), mesh.firstIndex, mesh.baseVertex, instancecount, baseinstance);
+}
@@ -28,8 +28,12 @@
 #include <gltoolbox/texture.h>
 using namespace gltoolbox;
 
+#include <atomic>
+
+static std::atomic<size_t> generations(0);
+
 Program::Program()
-    : mId(0), mOwned(false)
+    : mId(0), mOwned(false), mGeneration(0)
 {
   create();
 }
@@ -41,6 +45,7 @@ Program::Program(Program &&temp)
 
   mId = temp.mId;
   mOwned = temp.mOwned;
+  mGeneration = temp.mGeneration;
   mShaderList = std::move(temp.mShaderList);
   mUniformList = std::move(temp.mUniformList);
 
@@ -56,24 +61,49 @@ Program::~Program()
 
 bool Program::link() const
 {
+  invalidate_uniforms();
   if (is_valid())
     glLinkProgram(mId);
 
   return link_status();
 }
 
+void Program::link_deferred() const
+{
+  invalidate_uniforms();
+  if (is_valid())
+    glLinkProgram(mId);
+}
+
+bool Program::link(ProgramCache &cache, const std::map<GLenum, std::string> &sources)
+{
+  std::string key = cache.key(sources);
+  if (cache.load(key, *this))
+    return true;
+
+  for (const auto &[type, src] : sources)
+    attach_shader(src, type);
+
+  glProgramParameteri(mId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 1);
+  if (!link())
+    return false;
+
+  cache.store(key, *this);
+  return true;
+}
+
 bool Program::has_shader(GLenum type)
 {
   auto search = mShaderList.find(type);
   return (search != mShaderList.end());
 }
 
-void Program::attach_shader(const std::string &src, GLenum type)
+void Program::attach_shader(const std::string &src, GLenum type, bool deferred)
 {
   if (has_shader(type))
     detach_shader(type);
 
-  mShaderList[type] = std::make_shared<Shader>(src, type);
+  mShaderList[type] = std::make_shared<Shader>(src, type, deferred);
   glAttachShader(id(), mShaderList[type]->id());
 }
 
@@ -179,6 +209,29 @@ void Program::remove_uniform(const std::string &name)
   mUniformList.erase(name);
 }
 
+BaseUniform::Statistics Program::uniform_statistics() const
+{
+  BaseUniform::Statistics total = {0, 0};
+  for (const auto &[name, ptr] : mUniformList)
+  {
+    total.uploads += ptr->statistics().uploads;
+    total.redundant += ptr->statistics().redundant;
+  }
+  return total;
+}
+
+void Program::reset_uniform_statistics() const
+{
+  for (const auto &[name, ptr] : mUniformList)
+    ptr->reset_statistics();
+}
+
+void Program::invalidate_uniforms() const
+{
+  for (const auto &[name, ptr] : mUniformList)
+    ptr->invalidate();
+}
+
 std::string Program::info_log() const
 {
   std::string log;
@@ -194,6 +247,7 @@ void Program::create()
   {
     mId = glCreateProgram();
     mOwned = true;
+    mGeneration = ++generations;
   }
 }
 
@@ -0,0 +1,176 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/programbatch.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  double milliseconds(Clock::time_point from, Clock::time_point to)
+  {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+  }
+}
+
+ProgramBatch::ProgramBatch(ProgramCache *cache)
+    : mCache(cache), mPending(0), mElapsed(0.)
+{
+}
+
+ProgramBatch::~ProgramBatch()
+{
+}
+
+size_t ProgramBatch::add(Program &program, const std::map<GLenum, std::string> &sources)
+{
+  mEntries.push_back({&program, sources, "", false, false, false, {0., 0.}});
+  return mEntries.size() - 1;
+}
+
+void ProgramBatch::submit()
+{
+  mStart = Clock::now();
+  mPending = 0;
+
+  //compiles first so that the driver threads have every shader before the first link
+  for (auto &entry : mEntries)
+  {
+    if (entry.complete)
+      continue;
+
+    auto begin = Clock::now();
+    if (mCache)
+    {
+      entry.key = mCache->key(entry.sources);
+      entry.cached = mCache->load(entry.key, *entry.program);
+    }
+
+    if (entry.cached)
+    {
+      entry.complete = entry.linked = true;
+      entry.timing.ready = since_submit();
+    }
+    else
+    {
+      for (const auto &[type, src] : entry.sources)
+        entry.program->attach_shader(src, type, true);
+      mPending++;
+    }
+    entry.timing.submit = milliseconds(begin, Clock::now());
+  }
+
+  for (auto &entry : mEntries)
+  {
+    if (entry.complete)
+      continue;
+
+    auto begin = Clock::now();
+    if (mCache)
+      glProgramParameteri(entry.program->id(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, 1);
+    entry.program->link_deferred();
+    entry.timing.submit += milliseconds(begin, Clock::now());
+  }
+
+  mElapsed = since_submit();
+}
+
+bool ProgramBatch::poll()
+{
+  for (auto &entry : mEntries)
+    if (!entry.complete && entry.program->completion_status())
+      finish(entry);
+
+  return is_complete();
+}
+
+bool ProgramBatch::wait()
+{
+  //sleep between polls so the driver compile threads keep the cores,
+  //the last program has nothing left to overlap with and is waited on in the driver
+  std::chrono::microseconds delay(50);
+  while (!poll())
+  {
+    if (mPending == 1)
+    {
+      for (auto &entry : mEntries)
+        if (!entry.complete)
+          finish(entry);
+      break;
+    }
+
+    std::this_thread::sleep_for(delay);
+    delay = std::min(delay * 2, std::chrono::microseconds(2000));
+  }
+
+  bool success = true;
+  for (const auto &entry : mEntries)
+    success = success && entry.linked;
+  return success;
+}
+
+void ProgramBatch::clear()
+{
+  mEntries.clear();
+  mPending = 0;
+  mElapsed = 0.;
+}
+
+void ProgramBatch::finish(Entry &entry)
+{
+  entry.linked = entry.program->link_status();
+  entry.complete = true;
+  entry.timing.ready = since_submit();
+  mElapsed = entry.timing.ready;
+  mPending--;
+
+  if (entry.linked)
+  {
+    if (mCache)
+      mCache->store(entry.key, *entry.program);
+    return;
+  }
+
+  std::cerr << "[ProgramBatch::finish()] : unable to link program " << entry.program->id() << std::endl;
+  for (const auto &source : entry.sources)
+  {
+    const auto &shader = entry.program->get_shader(source.first);
+    if (!shader->compile_status())
+      std::cerr << "unable to compile " << shader->type_as_str() << std::endl
+                << shader->info_log() << std::endl;
+  }
+  std::cerr << entry.program->info_log() << std::endl;
+}
+
+double ProgramBatch::since_submit() const
+{
+  return milliseconds(mStart, Clock::now());
+}
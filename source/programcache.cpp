@@ -0,0 +1,204 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/programcache.h>
+#include <gltoolbox/program.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  const char MAGIC[4] = {'G', 'L', 'T', 'B'};
+
+  // FNV-1a
+  void hash_bytes(uint64_t &h, const void *data, size_t size)
+  {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+      h ^= bytes[i];
+      h *= 1099511628211ull;
+    }
+  }
+
+  std::string gl_string(GLenum name)
+  {
+    const GLubyte *str = glGetString(name);
+    return str ? std::string(reinterpret_cast<const char *>(str)) : std::string();
+  }
+}
+
+ProgramCache::ProgramCache(const std::string &directory)
+    : mDirectory(directory), mDriver(""), mStatistics{0, 0, 0, 0}
+{
+  std::error_code error;
+  std::filesystem::create_directories(mDirectory, error);
+}
+
+ProgramCache::~ProgramCache()
+{
+}
+
+std::string ProgramCache::key(const std::map<GLenum, std::string> &sources)
+{
+  if (mDriver.empty())
+  {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+    std::vector<GLint> formats(count);
+    if (count > 0)
+      glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+
+    std::ostringstream driver;
+    driver << gl_string(GL_VENDOR) << '\n'
+           << gl_string(GL_RENDERER) << '\n'
+           << gl_string(GL_VERSION) << '\n';
+    for (GLint format : formats)
+      driver << format << ' ';
+    mDriver = driver.str();
+  }
+
+  uint64_t h = 14695981039346656037ull;
+  hash_bytes(h, mDriver.data(), mDriver.size());
+  for (const auto &[type, src] : sources)
+  {
+    uint32_t stage = static_cast<uint32_t>(type);
+    uint64_t length = src.size();
+    hash_bytes(h, &stage, sizeof(stage));
+    hash_bytes(h, &length, sizeof(length));
+    hash_bytes(h, src.data(), src.size());
+  }
+
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(h));
+  return hex;
+}
+
+bool ProgramCache::load(const std::string &key, const Program &program)
+{
+  std::ifstream file(filename(key), std::ios::binary);
+  if (!file)
+  {
+    mStatistics.misses++;
+    return false;
+  }
+
+  char magic[4];
+  uint32_t format = 0;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&format), sizeof(format));
+  bool valid = file && std::equal(magic, magic + 4, MAGIC);
+
+  std::vector<char> binary;
+  if (valid)
+    binary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  valid = valid && !binary.empty();
+  if (valid)
+  {
+    program.invalidate_uniforms();
+    glProgramBinary(program.id(), static_cast<GLenum>(format), binary.data(), GLsizei(binary.size()));
+    valid = program.link_status();
+  }
+
+  // the driver refuses binaries of other versions, drop the entry
+  if (!valid)
+  {
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(filename(key), error);
+    mStatistics.rejected++;
+    return false;
+  }
+
+  mStatistics.hits++;
+  return true;
+}
+
+bool ProgramCache::store(const std::string &key, const Program &program)
+{
+  GLint length = 0;
+  glGetProgramiv(program.id(), GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return false;
+
+  std::vector<char> binary(length);
+  GLenum format;
+  glGetProgramBinary(program.id(), length, nullptr, &format, binary.data());
+
+  // written aside and renamed so that concurrent processes never read a partial file,
+  // the random suffix keeps writers of the same key from sharing the temporary file
+  std::string path = filename(key);
+  char suffix[32];
+  std::snprintf(suffix, sizeof(suffix), ".%08x%08x.tmp", std::random_device()(), std::random_device()());
+  std::string temporary = path + suffix;
+
+  std::error_code error;
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    uint32_t value = static_cast<uint32_t>(format);
+    file.write(MAGIC, sizeof(MAGIC));
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    file.write(binary.data(), binary.size());
+    if (!file)
+    {
+      file.close();
+      std::filesystem::remove(temporary, error);
+      return false;
+    }
+  }
+
+  std::filesystem::rename(temporary, path, error);
+  if (error)
+  {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+
+  mStatistics.stored++;
+  return true;
+}
+
+void ProgramCache::clear()
+{
+  std::error_code error;
+  for (const auto &entry : std::filesystem::directory_iterator(mDirectory, error))
+    if (entry.path().extension() == ".bin")
+      std::filesystem::remove(entry.path(), error);
+}
+
+std::string ProgramCache::filename(const std::string &key) const
+{
+  return (std::filesystem::path(mDirectory) / (key + ".bin")).string();
+}
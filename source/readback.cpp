@@ -0,0 +1,165 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/readback.h>
+#include <gltoolbox/buffer.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  struct Staging
+  {
+    std::unique_ptr<Buffer> buffer;
+    const void *ptr;
+  };
+
+  const size_t MAX_POOLED = 8;
+  const GLsizeiptr MIN_CAPACITY = 4096;
+
+  // one pool per thread, so per current context, and no locking is needed.
+  // never destroyed, the buffers would otherwise be deleted after the context at exit
+  std::vector<Staging> &pool()
+  {
+    static thread_local std::vector<Staging> *staging = new std::vector<Staging>();
+    return *staging;
+  }
+}
+
+void Readback::release_staging()
+{
+  pool().clear();
+}
+
+Readback::Readback()
+    : mPtr(nullptr), mSize(0)
+{
+}
+
+Readback::Readback(const Buffer &source, GLintptr offset, GLsizeiptr size)
+    : mPtr(nullptr), mSize(0)
+{
+  if (size <= 0)
+    return;
+
+  // smallest pooled staging buffer large enough
+  auto &staging = pool();
+  auto best = staging.end();
+  for (auto it = staging.begin(); it != staging.end(); ++it)
+    if (it->buffer->buffer_size() >= size && (best == staging.end() || it->buffer->buffer_size() < best->buffer->buffer_size()))
+      best = it;
+
+  if (best != staging.end())
+  {
+    mStaging = std::move(best->buffer);
+    mPtr = best->ptr;
+    staging.erase(best);
+  }
+  else
+  {
+    // power of two capacities so that buffers fit later requests
+    GLsizeiptr capacity = MIN_CAPACITY;
+    while (capacity < size)
+      capacity *= 2;
+
+    mStaging.reset(new Buffer(GL_COPY_WRITE_BUFFER, 1, GL_STREAM_READ));
+    mStaging->allocate_storage(GLsizei(capacity), GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_CLIENT_STORAGE_BIT);
+    mPtr = glMapNamedBufferRange(mStaging->id(), 0, capacity, GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+  }
+  mSize = size;
+  mOwner = std::this_thread::get_id();
+
+  // shader writes to the source must be made visible with GL_BUFFER_UPDATE_BARRIER_BIT beforehand
+  glCopyNamedBufferSubData(source.id(), mStaging->id(), offset, 0, size);
+
+  mFence.insert();
+}
+
+Readback::Readback(Readback &&temp)
+    : mStaging(std::move(temp.mStaging)), mFence(std::move(temp.mFence)), mPtr(temp.mPtr), mSize(temp.mSize),
+      mOwner(temp.mOwner)
+{
+  temp.mPtr = nullptr;
+  temp.mSize = 0;
+}
+
+Readback::~Readback()
+{
+  release();
+}
+
+Readback &Readback::operator=(Readback &&temp)
+{
+  release();
+
+  mStaging = std::move(temp.mStaging);
+  mFence = std::move(temp.mFence);
+  mPtr = temp.mPtr;
+  mSize = temp.mSize;
+  mOwner = temp.mOwner;
+
+  temp.mPtr = nullptr;
+  temp.mSize = 0;
+
+  return *this;
+}
+
+void Readback::release()
+{
+  if (mStaging && mPtr != nullptr && mOwner == std::this_thread::get_id())
+  {
+    auto &staging = pool();
+    staging.push_back({std::move(mStaging), mPtr});
+
+    // drop the smallest buffer past the pool size, deleting it also unmaps it
+    if (staging.size() > MAX_POOLED)
+      staging.erase(std::min_element(staging.begin(), staging.end(), [](const Staging &a, const Staging &b) {
+        return a.buffer->buffer_size() < b.buffer->buffer_size();
+      }));
+  }
+
+  mStaging.reset();
+  mPtr = nullptr;
+  mSize = 0;
+}
+
+bool Readback::ready()
+{
+  return is_valid() && mFence.is_signaled();
+}
+
+void Readback::wait()
+{
+  mFence.wait();
+}
+
+const void *Readback::data()
+{
+  wait();
+  return mPtr;
+}
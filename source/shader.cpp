@@ -41,11 +41,11 @@ Shader::Shader()
 {
 }
 
-Shader::Shader(const std::string &src, GLenum type)
+Shader::Shader(const std::string &src, GLenum type, bool deferred)
     : mId(0), mOwned(false), mFilename(""), mIsFromFile(false)
 {
   create(type);
-  set_source(src);
+  set_source(src, deferred);
 }
 
 Shader::Shader(Shader &&temp)
@@ -120,11 +120,19 @@ std::string Shader::source() const
   return src;
 }
 
-void Shader::set_source(const std::string &src) const
+void Shader::set_source(const std::string &src, bool deferred) const
 {
   const GLchar *_src = src.c_str();
   glShaderSource(mId, 1, (const GLchar **)&_src, 0);
 
+  //querying the status would wait for the compile to finish
+  if (deferred)
+  {
+    if (is_valid())
+      glCompileShader(mId);
+    return;
+  }
+
   bool success = compile();
   if (!success)
     std::cerr << "[shader::set_source()] : unable to compile " << type_as_str() << std::endl
@@ -0,0 +1,134 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/shadowbuffer.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+ShadowBuffer::ShadowBuffer(GLenum target, GLsizei elementsize, GLenum usage, GLsizeiptr mergedistance)
+    : Buffer(target, elementsize, usage), mMergeDistance(mergedistance)
+{
+}
+
+ShadowBuffer::~ShadowBuffer()
+{
+}
+
+GLsizeiptr ShadowBuffer::dirty_bytes() const
+{
+  GLsizeiptr bytes = 0;
+  for (const auto &[begin, end] : mDirty)
+    bytes += end - begin;
+  return bytes;
+}
+
+void ShadowBuffer::resize(GLsizei count)
+{
+  GLintptr previous = GLintptr(mShadow.size());
+  GLintptr size = GLintptr(count) * element_size();
+  mShadow.resize(size, 0);
+
+  //reallocate the gpu store with room to grow, the whole content is sent with the next flush
+  if (size > mSize)
+  {
+    upload(nullptr, std::max(count, 2 * capacity()));
+
+    mDirty.clear();
+    mDirty[0] = size;
+    return;
+  }
+
+  if (size > previous)
+  {
+    mark_dirty_bytes(previous, size);
+    return;
+  }
+
+  //drop the dirty bytes past the new end
+  auto it = mDirty.lower_bound(size);
+  mDirty.erase(it, mDirty.end());
+  if (!mDirty.empty())
+  {
+    auto last = std::prev(mDirty.end());
+    last->second = std::min(last->second, size);
+  }
+}
+
+void ShadowBuffer::write(const void *ptr, GLsizei offset, GLsizei count)
+{
+  std::memcpy(map(offset, count), ptr, GLsizeiptr(count) * element_size());
+}
+
+void *ShadowBuffer::map(GLsizei offset, GLsizei count)
+{
+  if (offset + count > this->count())
+    resize(offset + count);
+
+  mark_dirty(offset, count);
+  return mShadow.data() + GLintptr(offset) * element_size();
+}
+
+void ShadowBuffer::mark_dirty(GLsizei offset, GLsizei count)
+{
+  if (count > 0)
+    mark_dirty_bytes(GLintptr(offset) * element_size(), GLintptr(offset + count) * element_size());
+}
+
+GLsizeiptr ShadowBuffer::flush()
+{
+  GLsizeiptr bytes = 0;
+  for (const auto &[begin, end] : mDirty)
+  {
+    glNamedBufferSubData(id(), begin, end - begin, mShadow.data() + begin);
+    bytes += end - begin;
+  }
+  mDirty.clear();
+
+  return bytes;
+}
+
+void ShadowBuffer::mark_dirty_bytes(GLintptr begin, GLintptr end)
+{
+  end = std::min(end, GLintptr(mShadow.size()));
+
+  //first interval that can be merged with [begin, end)
+  auto it = mDirty.upper_bound(begin);
+  if (it != mDirty.begin() && std::prev(it)->second + mMergeDistance >= begin)
+    --it;
+
+  //absorb every interval closer than the merge distance
+  while (it != mDirty.end() && it->first <= end + mMergeDistance)
+  {
+    begin = std::min(begin, it->first);
+    end = std::max(end, it->second);
+    it = mDirty.erase(it);
+  }
+
+  mDirty[begin] = end;
+}
@@ -0,0 +1,76 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/streambuffer.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <cstring>
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizei elementsize, GLsizei capacity, GLuint regions)
+    : Buffer(target, elementsize, GL_STREAM_DRAW), mPtr(nullptr), mCapacity(capacity), mRegion(0), mFences(regions), mReserved(0)
+{
+  allocate_storage(regions * capacity, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+  mPtr = glMapNamedBufferRange(id(), 0, mSize, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+  if (mPtr != nullptr && is_valid())
+    glUnmapNamedBuffer(id());
+  mPtr = nullptr;
+}
+
+void *StreamBuffer::region_ptr()
+{
+  mFences[mRegion].wait();
+  return static_cast<char *>(mPtr) + region_offset();
+}
+
+void StreamBuffer::write(const void *ptr, GLsizei count)
+{
+  std::memcpy(region_ptr(), ptr, std::min(count, mCapacity) * element_size());
+}
+
+GLsizei StreamBuffer::reserve(GLsizei count)
+{
+  //only commit the reservation when it fits, a failed one leaves the count untouched
+  GLsizei first = mReserved.load();
+  do
+  {
+    if (first + count > mCapacity)
+      return -1;
+  } while (!mReserved.compare_exchange_weak(first, first + count));
+
+  return region_first() + first;
+}
+
+void StreamBuffer::next_region()
+{
+  mFences[mRegion].insert();
+  mRegion = (mRegion + 1) % num_regions();
+  mReserved = 0;
+}
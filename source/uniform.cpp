@@ -29,17 +29,17 @@
 using namespace gltoolbox;
 
 BaseUniform::BaseUniform(Program *prog, GLint location)
-    : mProg(prog), mLocation(location), mName("")
+    : mProg(prog), mLocation(location), mName(""), mStatistics{0, 0}
 {
 }
 
 BaseUniform::BaseUniform(Program *prog, const std::string &name)
-    : mProg(prog), mLocation(-1), mName(name)
+    : mProg(prog), mLocation(-1), mName(name), mStatistics{0, 0}
 {
 }
 
 BaseUniform::BaseUniform(Program *prog, GLint location, const std::string &name)
-    : mProg(prog), mLocation(location), mName(name)
+    : mProg(prog), mLocation(location), mName(name), mStatistics{0, 0}
 {
 }
 
@@ -0,0 +1,236 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/uploadqueue.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+// size in bytes of one pixel with the given format and type
+static GLsizei pixel_size(GLenum format, GLenum type)
+{
+  GLsizei components = 4;
+  switch (format)
+  {
+  case GL_RED:
+  case GL_GREEN:
+  case GL_BLUE:
+  case GL_RED_INTEGER:
+  case GL_DEPTH_COMPONENT:
+  case GL_STENCIL_INDEX:
+    components = 1;
+    break;
+  case GL_RG:
+  case GL_RG_INTEGER:
+  case GL_DEPTH_STENCIL:
+    components = 2;
+    break;
+  case GL_RGB:
+  case GL_BGR:
+  case GL_RGB_INTEGER:
+  case GL_BGR_INTEGER:
+    components = 3;
+    break;
+  default:
+    break;
+  }
+
+  switch (type)
+  {
+  case GL_UNSIGNED_BYTE:
+  case GL_BYTE:
+    return components;
+  case GL_UNSIGNED_SHORT:
+  case GL_SHORT:
+  case GL_HALF_FLOAT:
+    return 2 * components;
+  case GL_UNSIGNED_INT:
+  case GL_INT:
+  case GL_FLOAT:
+    return 4 * components;
+  case GL_UNSIGNED_BYTE_3_3_2:
+  case GL_UNSIGNED_BYTE_2_3_3_REV:
+    return 1;
+  case GL_UNSIGNED_SHORT_5_6_5:
+  case GL_UNSIGNED_SHORT_5_6_5_REV:
+  case GL_UNSIGNED_SHORT_4_4_4_4:
+  case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+  case GL_UNSIGNED_SHORT_5_5_5_1:
+  case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+    return 2;
+  default: // packed 32 bits formats
+    return 4;
+  }
+}
+
+UploadQueue::UploadQueue(GLsizeiptr capacity, GLuint regions)
+    : mStaging(new StreamBuffer(GL_COPY_READ_BUFFER, 1, GLsizei(capacity), regions)), mCursor(0)
+{
+  mStats = {0, 0, 0, 0};
+}
+
+UploadQueue::~UploadQueue()
+{
+}
+
+void UploadQueue::enqueue(const Buffer &dst, GLintptr offset, const void *ptr, GLsizeiptr size)
+{
+  //too large to be staged, send it directly once the queued writes landed so that it wins over them
+  if (size > capacity())
+  {
+    flush();
+    glNamedBufferSubData(dst.id(), offset, size, ptr);
+    return;
+  }
+
+  GLintptr src = stage(ptr, size, 1);
+  mBufferRequests.push_back({&dst, dst.generation(), offset, src, size});
+}
+
+void UploadQueue::enqueue(const BufferRange &dst, GLintptr offset, const void *ptr, GLsizeiptr size)
+{
+  enqueue(*dst.buffer(), dst.offset() + offset, ptr, size);
+}
+
+void UploadQueue::enqueue(const Texture &dst, const void *ptr,
+                          GLsizei width, GLsizei height, GLsizei depth,
+                          GLint x, GLint y, GLint z, GLint level)
+{
+  GLint alignment;
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+
+  GLsizeiptr row = GLsizeiptr(width) * pixel_size(dst.format(), dst.type());
+  row = ((row + alignment - 1) / alignment) * alignment;
+  GLsizeiptr size = row * height * depth;
+
+  TextureRequest request = {&dst, dst.dim(), dst.format(), dst.type(), alignment,
+                            level, x, y, z, width, height, depth, 0, size};
+
+  //too large to be staged, send it directly once the queued writes landed so that it wins over them
+  if (size > capacity())
+  {
+    flush();
+    if (request.dim == 1)
+      glTextureSubImage1D(GLuint(dst.id()), level, x, width, request.format, request.type, ptr);
+    else if (request.dim == 2)
+      glTextureSubImage2D(GLuint(dst.id()), level, x, y, width, height, request.format, request.type, ptr);
+    else if (request.dim == 3)
+      glTextureSubImage3D(GLuint(dst.id()), level, x, y, z, width, height, depth, request.format, request.type, ptr);
+    return;
+  }
+
+  request.srcOffset = stage(ptr, size, 16);
+  mTextureRequests.push_back(request);
+}
+
+void UploadQueue::flush()
+{
+  mStats = {mCursor, pending_requests(), 0, 0};
+  if (pending_requests() == 0)
+    return;
+
+  GLintptr base = mStaging->region_offset();
+
+  //group updates by destination, order is kept within a destination so later writes win
+  std::stable_sort(mBufferRequests.begin(), mBufferRequests.end(),
+                   [](const BufferRequest &a, const BufferRequest &b) { return std::less<const Buffer *>()(a.dst, b.dst); });
+
+  size_t i = 0;
+  while (i < mBufferRequests.size())
+  {
+    BufferRequest run = mBufferRequests[i++];
+
+    //the offsets were computed for a store that no longer exists
+    if (run.dst->generation() != run.generation)
+    {
+      std::cerr << "[UploadQueue::flush()] : destination buffer reallocated since the update was queued, update dropped" << std::endl;
+      mStats.dropped++;
+      continue;
+    }
+
+    //merge requests contiguous both in the staging buffer and in the destination
+    while (i < mBufferRequests.size() &&
+           mBufferRequests[i].dst == run.dst &&
+           mBufferRequests[i].generation == run.generation &&
+           mBufferRequests[i].dstOffset == run.dstOffset + run.size &&
+           mBufferRequests[i].srcOffset == run.srcOffset + run.size)
+      run.size += mBufferRequests[i++].size;
+
+    glCopyNamedBufferSubData(mStaging->id(), run.dst->id(), base + run.srcOffset, run.dstOffset, run.size);
+    mStats.commands++;
+  }
+
+  if (!mTextureRequests.empty())
+  {
+    std::stable_sort(mTextureRequests.begin(), mTextureRequests.end(),
+                     [](const TextureRequest &a, const TextureRequest &b) { return std::less<const Texture *>()(a.dst, b.dst); });
+
+    GLint alignment;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mStaging->id());
+    for (const auto &request : mTextureRequests)
+    {
+      glPixelStorei(GL_UNPACK_ALIGNMENT, request.alignment);
+
+      GLvoid *src = (GLvoid *)(base + request.srcOffset);
+      if (request.dim == 1)
+        glTextureSubImage1D(GLuint(request.dst->id()), request.level, request.x, request.width, request.format, request.type, src);
+      else if (request.dim == 2)
+        glTextureSubImage2D(GLuint(request.dst->id()), request.level, request.x, request.y, request.width, request.height, request.format, request.type, src);
+      else if (request.dim == 3)
+        glTextureSubImage3D(GLuint(request.dst->id()), request.level, request.x, request.y, request.z, request.width, request.height, request.depth, request.format, request.type, src);
+      mStats.commands++;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+  }
+
+  //the region is reused once the gpu went through these copies
+  mStaging->next_region();
+  mBufferRequests.clear();
+  mTextureRequests.clear();
+  mCursor = 0;
+}
+
+GLintptr UploadQueue::stage(const void *ptr, GLsizeiptr size, GLsizeiptr alignment)
+{
+  GLintptr offset = ((mCursor + alignment - 1) / alignment) * alignment;
+  if (offset + size > capacity())
+  {
+    flush();
+    offset = 0;
+  }
+
+  std::memcpy(mStaging->region_ptr<char>() + offset, ptr, size);
+  mCursor = offset + size;
+
+  return offset;
+}
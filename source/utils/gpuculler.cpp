@@ -0,0 +1,263 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/utils/gpuculler.h>
+#include <gltoolbox/indirectcommandbuffer.h>
+using namespace gltoolbox;
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Shaders //-------------------------------------------------------//
+const std::string cullShader = "#version 450 core \n"
+                               "layout(local_size_x = 64) in; \n"
+                               "struct Object { vec4 sphere; uint count; uint firstIndex; int baseVertex; uint baseInstance; }; \n"
+                               "struct Command { uint count; uint instanceCount; uint firstIndex; int baseVertex; uint baseInstance; }; \n"
+                               "layout(std430, binding = 0) readonly buffer Objects { Object objects[]; }; \n"
+                               "layout(std430, binding = 1) writeonly buffer Commands { Command commands[]; }; \n"
+                               "layout(std430, binding = 2) buffer DrawCount { uint drawCount; }; \n"
+                               "layout(binding = 0) uniform sampler2D pyramid; \n"
+                               "uniform uint numObjects; \n"
+                               "uniform vec4 planes[6]; \n"
+                               "uniform vec4 viewProj[4]; \n"
+                               "uniform int useOcclusion; \n"
+                               "uniform vec2 pyramidSize; \n"
+                               "uniform int pyramidLevels; \n"
+                               "bool occluded(vec4 sphere) { \n"
+                               "  mat4 vp = mat4(viewProj[0], viewProj[1], viewProj[2], viewProj[3]); \n"
+                               "  vec3 lo = vec3(1.0), hi = vec3(-1.0); \n"
+                               "  for (int c = 0; c < 8; ++c) { \n"
+                               "    vec3 corner = sphere.xyz + sphere.w * vec3((c & 1) != 0 ? 1.0 : -1.0, (c & 2) != 0 ? 1.0 : -1.0, (c & 4) != 0 ? 1.0 : -1.0); \n"
+                               "    vec4 clip = vp * vec4(corner, 1.0); \n"
+                               "    if (clip.w <= 0.0) return false; \n"
+                               "    vec3 ndc = clip.xyz / clip.w; \n"
+                               "    lo = min(lo, ndc); hi = max(hi, ndc); \n"
+                               "  } \n"
+                               "  vec2 uvlo = clamp(lo.xy * 0.5 + 0.5, 0.0, 1.0), uvhi = clamp(hi.xy * 0.5 + 0.5, 0.0, 1.0); \n"
+                               "  vec2 size = (uvhi - uvlo) * pyramidSize; \n"
+                               "  float level = clamp(ceil(log2(max(max(size.x, size.y), 1.0))), 0.0, float(pyramidLevels - 1)); \n"
+                               "  float depth = max(max(textureLod(pyramid, uvlo, level).r, textureLod(pyramid, vec2(uvhi.x, uvlo.y), level).r), \n"
+                               "                    max(textureLod(pyramid, vec2(uvlo.x, uvhi.y), level).r, textureLod(pyramid, uvhi, level).r)); \n"
+                               "  return lo.z * 0.5 + 0.5 > depth; \n"
+                               "} \n"
+                               "void main(void) { \n"
+                               "  uint i = gl_GlobalInvocationID.x; \n"
+                               "  if (i >= numObjects) return; \n"
+                               "  Object o = objects[i]; \n"
+                               "  for (int p = 0; p < 6; ++p) \n"
+                               "    if (dot(planes[p].xyz, o.sphere.xyz) + planes[p].w < -o.sphere.w) return; \n"
+                               "  if (useOcclusion != 0 && occluded(o.sphere)) return; \n"
+                               "  uint slot = atomicAdd(drawCount, 1u); \n"
+                               "  commands[slot] = Command(o.count, 1u, o.firstIndex, o.baseVertex, o.baseInstance); \n"
+                               "}";
+
+const std::string reduceShader = "#version 450 core \n"
+                                 "layout(local_size_x = 8, local_size_y = 8) in; \n"
+                                 "layout(binding = 0) uniform sampler2D source; \n"
+                                 "layout(r32f, binding = 0) writeonly uniform image2D target; \n"
+                                 "uniform int level; \n"
+                                 "uniform ivec2 sourceSize; \n"
+                                 "void main(void) { \n"
+                                 "  ivec2 p = ivec2(gl_GlobalInvocationID.xy); \n"
+                                 "  ivec2 size = imageSize(target); \n"
+                                 "  if (any(greaterThanEqual(p, size))) return; \n"
+                                 "  if (level < 0) { imageStore(target, p, vec4(texelFetch(source, p, 0).r)); return; } \n"
+                                 "  ivec2 extra = ivec2(((sourceSize.x & 1) != 0 && p.x == size.x - 1) ? 2 : 1, \n"
+                                 "                      ((sourceSize.y & 1) != 0 && p.y == size.y - 1) ? 2 : 1); \n"
+                                 "  float depth = 0.0; \n"
+                                 "  for (int y = 0; y <= extra.y; ++y) \n"
+                                 "    for (int x = 0; x <= extra.x; ++x) \n"
+                                 "      depth = max(depth, texelFetch(source, min(2 * p + ivec2(x, y), sourceSize - 1), level).r); \n"
+                                 "  imageStore(target, p, vec4(depth)); \n"
+                                 "}";
+
+//------------------------------------------------------------------//
+
+GpuCuller::GpuCuller(bool doInit)
+    : mIsInit(false), mNumObjects(0), mUseOcclusion(false), mPyramidWidth(0), mPyramidHeight(0), mPyramidLevels(0)
+{
+  if (doInit)
+    init();
+}
+
+GpuCuller::~GpuCuller()
+{
+}
+
+void GpuCuller::set_objects(const std::vector<CullObject> &objects)
+{
+  if (!mIsInit)
+    init();
+
+  mNumObjects = GLsizei(objects.size());
+  mObjects->upload(const_cast<CullObject *>(objects.data()), mNumObjects);
+
+  // at most one command per object
+  mCommands = std::make_unique<Buffer>(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand));
+  mCommands->allocate_storage(std::max(mNumObjects, 1), GL_NONE_BIT);
+}
+
+void GpuCuller::build_depth_pyramid(const Texture &depth, GLsizei width, GLsizei height)
+{
+  if (!mIsInit)
+    init();
+
+  // storage for the full mip chain, reallocated when the size changes
+  if (!mPyramid || width != mPyramidWidth || height != mPyramidHeight)
+  {
+    mPyramid = std::make_unique<Texture>(GL_TEXTURE_2D, GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE);
+    mPyramidWidth = width;
+    mPyramidHeight = height;
+    mPyramidLevels = 1 + GLint(std::floor(std::log2(float(std::max(width, height)))));
+    glTextureStorage2D(GLuint(mPyramid->id()), mPyramidLevels, GL_R32F, width, height);
+  }
+
+  mReducePrg.use();
+  GLsizei w = width, h = height;
+  for (GLint level = 0; level < mPyramidLevels; ++level)
+  {
+    // level 0 is a copy of the depth, the others reduce the previous level
+    GLint source = level - 1;
+    std::array<int, 2> sourceSize{width, height};
+    if (level > 0)
+      sourceSize = {std::max(width >> source, 1), std::max(height >> source, 1)};
+
+    mReducePrg.enable_uniform("level", &source);
+    mReducePrg.enable_uniform("sourceSize", &sourceSize);
+
+    glBindTextureUnit(0, GLuint(level == 0 ? depth.id() : mPyramid->id()));
+    glBindImageTexture(0, GLuint(mPyramid->id()), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute(GLuint(w + 7) / 8, GLuint(h + 7) / 8, 1);
+    glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+    w = std::max(w / 2, 1);
+    h = std::max(h / 2, 1);
+  }
+  mReducePrg.unuse();
+}
+
+void GpuCuller::cull(const float *viewproj)
+{
+  if (!mIsInit)
+    init();
+
+  // normalized frustum planes of the column major matrix (Gribb/Hartmann)
+  std::array<std::array<float, 4>, 6> planes;
+  for (int p = 0; p < 6; ++p)
+  {
+    int row = p / 2;
+    float sign = (p % 2 == 0) ? 1.f : -1.f;
+    for (int k = 0; k < 4; ++k)
+      planes[p][k] = viewproj[4 * k + 3] + sign * viewproj[4 * k + row];
+
+    float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1] + planes[p][2] * planes[p][2]);
+    for (int k = 0; k < 4; ++k)
+      planes[p][k] /= length;
+  }
+
+  std::array<std::array<float, 4>, 4> columns;
+  for (int c = 0; c < 4; ++c)
+    std::copy(viewproj + 4 * c, viewproj + 4 * c + 4, columns[c].begin());
+
+  GLuint count = GLuint(mNumObjects);
+  GLint occlusion = (mUseOcclusion && mPyramid) ? 1 : 0;
+  std::array<float, 2> pyramidSize{float(mPyramidWidth), float(mPyramidHeight)};
+
+  mCullPrg.enable_uniform("numObjects", &count);
+  mCullPrg.enable_uniform("planes", planes.data(), 6);
+  mCullPrg.enable_uniform("viewProj", columns.data(), 4);
+  mCullPrg.enable_uniform("useOcclusion", &occlusion);
+  mCullPrg.enable_uniform("pyramidSize", &pyramidSize);
+  mCullPrg.enable_uniform("pyramidLevels", &mPyramidLevels);
+
+  // reset the counter on the gpu
+  GLuint zero = 0;
+  glClearNamedBufferData(mDrawCount->id(), GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+
+  if (mNumObjects == 0)
+    return;
+
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, mObjects->id());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, mCommands->id());
+  glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, mDrawCount->id());
+  if (occlusion)
+    glBindTextureUnit(0, GLuint(mPyramid->id()));
+
+  mCullPrg.use();
+  glDispatchCompute(GLuint(mNumObjects + 63) / 64, 1, 1);
+  mCullPrg.unuse();
+
+  // commands and count are consumed by the next indirect draw
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCuller::draw(const VertexArray &vao) const
+{
+  if (mNumObjects > 0)
+    vao.multi_draw_elements_indirect_count(*mCommands, *mDrawCount, mNumObjects);
+}
+
+GLuint GpuCuller::read_draw_count() const
+{
+  //the count was written by the compute pass through an ssbo
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  GLuint count = 0;
+  mDrawCount->download(&count, 0, sizeof(GLuint));
+  return count;
+}
+
+void GpuCuller::init()
+{
+  mCullPrg.attach_shader(cullShader, GL_COMPUTE_SHADER);
+  if (!mCullPrg.link())
+    std::cerr << "[GpuCuller::init()] : unable to link the culling program" << std::endl
+              << mCullPrg.info_log() << std::endl;
+
+  mCullPrg.add_uniform<unsigned int>("numObjects");
+  mCullPrg.add_uniform<std::array<float, 4>>("planes");
+  mCullPrg.add_uniform<std::array<float, 4>>("viewProj");
+  mCullPrg.add_uniform<int>("useOcclusion");
+  mCullPrg.add_uniform<std::array<float, 2>>("pyramidSize");
+  mCullPrg.add_uniform<int>("pyramidLevels");
+
+  mReducePrg.attach_shader(reduceShader, GL_COMPUTE_SHADER);
+  if (!mReducePrg.link())
+    std::cerr << "[GpuCuller::init()] : unable to link the depth reduction program" << std::endl
+              << mReducePrg.info_log() << std::endl;
+
+  mReducePrg.add_uniform<int>("level");
+  mReducePrg.add_uniform<std::array<int, 2>>("sourceSize");
+
+  mObjects = std::make_unique<Buffer>(GL_SHADER_STORAGE_BUFFER, sizeof(CullObject), GL_DYNAMIC_DRAW);
+  mCommands = std::make_unique<Buffer>(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand));
+  mCommands->allocate_storage(1, GL_NONE_BIT);
+  mDrawCount = std::make_unique<Buffer>(GL_PARAMETER_BUFFER, sizeof(GLuint));
+  mDrawCount->allocate_storage(1, GL_DYNAMIC_STORAGE_BIT);
+
+  mIsInit = true;
+}
@@ -0,0 +1,129 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/utils/loader.h>
+using namespace gltoolbox;
+
+Loader::Loader(std::function<void()> activate, std::function<void()> deactivate)
+    : mActivate(activate), mDeactivate(deactivate), mPending(0), mStop(false)
+{
+  mThread = std::thread(&Loader::run, this);
+}
+
+Loader::~Loader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStop = true;
+  }
+  mCondition.notify_all();
+
+  if (mThread.joinable())
+    mThread.join();
+}
+
+std::shared_ptr<LoadTask<Buffer>> Loader::load_buffer(GLenum target, GLsizei elementsize,
+                                                      std::vector<char> data, GLenum usage)
+{
+  auto content = std::make_shared<std::vector<char>>(std::move(data));
+  return submit<Buffer>([=]() {
+    auto buffer = std::make_shared<Buffer>(target, elementsize, usage);
+    buffer->upload(content->data(), GLsizei(content->size() / elementsize));
+    return buffer;
+  });
+}
+
+std::shared_ptr<LoadTask<Texture>> Loader::load_texture(GLenum target, GLenum format, GLenum type,
+                                                        std::vector<char> pixels,
+                                                        GLsizei width, GLsizei height, GLsizei depth,
+                                                        bool mipmaps)
+{
+  auto content = std::make_shared<std::vector<char>>(std::move(pixels));
+  return submit<Texture>([=]() {
+    auto texture = std::make_shared<Texture>(target);
+    texture->set_format(format);
+    texture->set_type(type);
+
+    if (texture->dim() == 1)
+      texture->upload(content->data(), width);
+    else if (texture->dim() == 2)
+      texture->upload(content->data(), width, height);
+    else if (texture->dim() == 3)
+      texture->upload(content->data(), width, height, depth);
+
+    if (mipmaps)
+      texture->generate_mipmaps();
+
+    return texture;
+  });
+}
+
+void Loader::finish()
+{
+  std::unique_lock<std::mutex> lock(mMutex);
+  mIdle.wait(lock, [this]() { return mPending == 0; });
+}
+
+void Loader::push(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mJobs.push_back(std::move(job));
+    mPending++;
+  }
+  mCondition.notify_one();
+}
+
+void Loader::run()
+{
+  if (mActivate)
+    mActivate();
+
+  while (true)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mCondition.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+      if (mStop && mJobs.empty())
+        break;
+
+      job = std::move(mJobs.front());
+      mJobs.pop_front();
+    }
+
+    job();
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mPending--;
+    }
+    mIdle.notify_all();
+  }
+
+  if (mDeactivate)
+    mDeactivate();
+}
@@ -0,0 +1,312 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/utils/meshlets.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gltoolbox
+{
+  namespace
+  {
+    inline const float *position(const float *positions, GLsizei stride, GLuint v)
+    {
+      return reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + size_t(v) * stride);
+    }
+
+    void compute_bounds(Meshlet &meshlet, const GLuint *indices, const float *positions, GLsizei stride)
+    {
+      // sphere around the box center
+      float lo[3] = {1e30f, 1e30f, 1e30f}, hi[3] = {-1e30f, -1e30f, -1e30f};
+      for (GLsizei i = 0; i < meshlet.count; ++i)
+      {
+        const float *p = position(positions, stride, indices[i]);
+        for (int k = 0; k < 3; ++k)
+          lo[k] = std::min(lo[k], p[k]), hi[k] = std::max(hi[k], p[k]);
+      }
+
+      float radius = 0.f;
+      for (int k = 0; k < 3; ++k)
+        meshlet.center[k] = 0.5f * (lo[k] + hi[k]);
+      for (GLsizei i = 0; i < meshlet.count; ++i)
+      {
+        const float *p = position(positions, stride, indices[i]);
+        float dx = p[0] - meshlet.center[0], dy = p[1] - meshlet.center[1], dz = p[2] - meshlet.center[2];
+        radius = std::max(radius, dx * dx + dy * dy + dz * dz);
+      }
+      meshlet.radius = std::sqrt(radius);
+
+      // normal cone around the mean triangle normal
+      std::vector<float> normals;
+      float axis[3] = {0.f, 0.f, 0.f};
+      for (GLsizei t = 0; t < meshlet.count; t += 3)
+      {
+        const float *a = position(positions, stride, indices[t]);
+        const float *b = position(positions, stride, indices[t + 1]);
+        const float *c = position(positions, stride, indices[t + 2]);
+        float u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        float v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+        float n[3] = {u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]};
+
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length == 0.f)
+          continue;
+
+        for (int k = 0; k < 3; ++k)
+        {
+          normals.push_back(n[k] / length);
+          axis[k] += n[k] / length;
+        }
+      }
+
+      float length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+      float mindot = -1.f;
+      if (length > 0.f)
+      {
+        mindot = 1.f;
+        for (size_t n = 0; n < normals.size(); n += 3)
+          mindot = std::min(mindot, (normals[n] * axis[0] + normals[n + 1] * axis[1] + normals[n + 2] * axis[2]) / length);
+      }
+
+      for (int k = 0; k < 3; ++k)
+        meshlet.coneAxis[k] = (length > 0.f) ? axis[k] / length : 0.f;
+
+      // a cone wider than a half space is never entirely back facing
+      meshlet.coneCutoff = (mindot > 0.f) ? std::sqrt(1.f - mindot * mindot) : 1.f;
+    }
+  }
+
+  std::vector<Meshlet> build_meshlets(const GLuint *indices, GLsizei count,
+                                      const float *positions, GLsizei stride,
+                                      GLsizei maxtriangles, GLsizei maxvertices)
+  {
+    std::vector<Meshlet> meshlets;
+    std::vector<GLuint> vertices; // unique vertices of the current meshlet
+
+    Meshlet current = {};
+    for (GLsizei t = 0; t + 2 < count; t += 3)
+    {
+      // vertices the triangle adds to the meshlet
+      GLsizei added = 0;
+      for (int k = 0; k < 3; ++k)
+        if (std::find(vertices.begin(), vertices.end(), indices[t + k]) == vertices.end() &&
+            std::find(indices + t, indices + t + k, indices[t + k]) == indices + t + k)
+          ++added;
+
+      if (current.count > 0 && (current.count / 3 >= maxtriangles || GLsizei(vertices.size()) + added > maxvertices))
+      {
+        compute_bounds(current, indices + current.firstIndex, positions, stride);
+        meshlets.push_back(current);
+
+        current = {};
+        current.firstIndex = GLuint(t);
+        vertices.clear();
+      }
+
+      for (int k = 0; k < 3; ++k)
+        if (std::find(vertices.begin(), vertices.end(), indices[t + k]) == vertices.end())
+          vertices.push_back(indices[t + k]);
+      current.count += 3;
+    }
+
+    if (current.count > 0)
+    {
+      compute_bounds(current, indices + current.firstIndex, positions, stride);
+      meshlets.push_back(current);
+    }
+
+    return meshlets;
+  }
+
+  //=====================================================
+  // ClusterCuller
+  //=====================================================
+
+  ClusterCuller::ClusterCuller(unsigned numthreads)
+      : mGeneration(0), mRunning(0), mStop(false), mMeshlets(nullptr), mActive(1), mStatistics{}
+  {
+    numthreads = std::max(numthreads, 1u);
+    mChunks.resize(numthreads);
+
+    // the calling thread culls the first chunk
+    for (unsigned chunk = 1; chunk < numthreads; ++chunk)
+      mWorkers.emplace_back(&ClusterCuller::run, this, chunk);
+  }
+
+  ClusterCuller::~ClusterCuller()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStop = true;
+    }
+    mStart.notify_all();
+
+    for (auto &worker : mWorkers)
+      if (worker.joinable())
+        worker.join();
+  }
+
+  GLsizei ClusterCuller::cull(const std::vector<Meshlet> &meshlets, const float *viewproj, const float *eye)
+  {
+    // frustum planes of the column major matrix (Gribb/Hartmann), normalized for sphere tests
+    for (int p = 0; p < 6; ++p)
+    {
+      int row = p / 2;
+      float sign = (p % 2 == 0) ? 1.f : -1.f;
+      for (int k = 0; k < 4; ++k)
+        mPlanes[p][k] = viewproj[4 * k + 3] + sign * viewproj[4 * k + row];
+
+      float length = std::sqrt(mPlanes[p][0] * mPlanes[p][0] + mPlanes[p][1] * mPlanes[p][1] + mPlanes[p][2] * mPlanes[p][2]);
+      for (int k = 0; k < 4; ++k)
+        mPlanes[p][k] /= length;
+    }
+    std::copy(eye, eye + 3, mEye);
+    mMeshlets = &meshlets;
+
+    // wake the workers and take the first chunk, small jobs are not worth waking them
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mActive = unsigned(std::min(size_t(num_threads()), std::max(meshlets.size() / MIN_CHUNK, size_t(1))));
+      mRunning = mActive - 1;
+      if (mActive > 1)
+        ++mGeneration;
+    }
+    if (mActive > 1)
+      mStart.notify_all();
+
+    for (unsigned chunk = mActive; chunk < mChunks.size(); ++chunk)
+      cull_chunk(chunk);
+
+    cull_chunk(0);
+
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mDone.wait(lock, [this]() { return mRunning == 0; });
+    }
+
+    // concatenate the chunks in order, merging ranges across chunk borders
+    mFirst.clear();
+    mCounts.clear();
+    mStatistics = {meshlets.size(), 0, 0, 0};
+    for (const Chunk &chunk : mChunks)
+    {
+      for (size_t r = 0; r < chunk.first.size(); ++r)
+      {
+        if (!mFirst.empty() && mFirst.back() + GLuint(mCounts.back()) == chunk.first[r])
+          mCounts.back() += chunk.counts[r];
+        else
+        {
+          mFirst.push_back(chunk.first[r]);
+          mCounts.push_back(chunk.counts[r]);
+        }
+      }
+      mStatistics.frustumCulled += chunk.frustumCulled;
+      mStatistics.backfaceCulled += chunk.backfaceCulled;
+    }
+    mStatistics.ranges = mFirst.size();
+
+    return GLsizei(mFirst.size());
+  }
+
+  void ClusterCuller::draw(const VertexArray &vao) const
+  {
+    if (!mFirst.empty())
+      vao.multi_draw_sub_elements(mFirst.data(), mCounts.data(), GLsizei(mFirst.size()));
+  }
+
+  void ClusterCuller::cull_chunk(unsigned chunk)
+  {
+    const std::vector<Meshlet> &meshlets = *mMeshlets;
+    size_t begin = std::min(meshlets.size() * chunk / mActive, meshlets.size());
+    size_t end = std::min(meshlets.size() * (chunk + 1) / mActive, meshlets.size());
+
+    Chunk &out = mChunks[chunk];
+    out.first.clear();
+    out.counts.clear();
+    out.frustumCulled = 0;
+    out.backfaceCulled = 0;
+
+    for (size_t m = begin; m < end; ++m)
+    {
+      const Meshlet &meshlet = meshlets[m];
+
+      // sphere outside one of the planes
+      bool outside = false;
+      for (int p = 0; p < 6 && !outside; ++p)
+        outside = mPlanes[p][0] * meshlet.center[0] + mPlanes[p][1] * meshlet.center[1] +
+                      mPlanes[p][2] * meshlet.center[2] + mPlanes[p][3] <
+                  -meshlet.radius;
+
+      if (outside)
+      {
+        ++out.frustumCulled;
+        continue;
+      }
+
+      // every triangle faces away from the eye
+      float view[3] = {meshlet.center[0] - mEye[0], meshlet.center[1] - mEye[1], meshlet.center[2] - mEye[2]};
+      float distance = std::sqrt(view[0] * view[0] + view[1] * view[1] + view[2] * view[2]);
+      float along = view[0] * meshlet.coneAxis[0] + view[1] * meshlet.coneAxis[1] + view[2] * meshlet.coneAxis[2];
+      if (along >= meshlet.coneCutoff * distance + meshlet.radius)
+      {
+        ++out.backfaceCulled;
+        continue;
+      }
+
+      if (!out.first.empty() && out.first.back() + GLuint(out.counts.back()) == meshlet.firstIndex)
+        out.counts.back() += meshlet.count;
+      else
+      {
+        out.first.push_back(meshlet.firstIndex);
+        out.counts.push_back(meshlet.count);
+      }
+    }
+  }
+
+  void ClusterCuller::run(unsigned chunk)
+  {
+    size_t generation = 0;
+    while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mStart.wait(lock, [&]() { return mStop || (mGeneration != generation && chunk < mActive); });
+        if (mStop)
+          break;
+        generation = mGeneration;
+      }
+
+      cull_chunk(chunk);
+
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        --mRunning;
+      }
+      mDone.notify_one();
+    }
+  }
+}
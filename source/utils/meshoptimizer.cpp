@@ -0,0 +1,235 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/utils/meshoptimizer.h>
+
+#include <cstdint>
+#include <cstring>
+
+namespace gltoolbox
+{
+  namespace
+  {
+    // FNV-1a over the vertex bytes
+    uint64_t hash_vertex(const char *vertex, GLsizei stride)
+    {
+      uint64_t h = 14695981039346656037ull;
+      for (GLsizei i = 0; i < stride; ++i)
+      {
+        h ^= uint8_t(vertex[i]);
+        h *= 1099511628211ull;
+      }
+      return h;
+    }
+  }
+
+  GLsizei weld_vertices(const void *vertices, GLsizei numvertices, GLsizei stride, std::vector<GLuint> &remap)
+  {
+    const char *data = static_cast<const char *>(vertices);
+    remap.resize(numvertices);
+
+    // open addressing table of vertex ids, at most half full
+    size_t capacity = 1;
+    while (capacity < 2 * size_t(numvertices))
+      capacity *= 2;
+
+    const GLuint empty = ~0u;
+    std::vector<GLuint> table(capacity, empty);
+
+    GLsizei unique = 0;
+    for (GLsizei v = 0; v < numvertices; ++v)
+    {
+      const char *vertex = data + size_t(v) * stride;
+      size_t slot = hash_vertex(vertex, stride) & (capacity - 1);
+
+      while (table[slot] != empty && std::memcmp(data + size_t(table[slot]) * stride, vertex, stride) != 0)
+        slot = (slot + 1) & (capacity - 1);
+
+      if (table[slot] == empty)
+      {
+        table[slot] = GLuint(v);
+        ++unique;
+      }
+      remap[v] = table[slot];
+    }
+
+    return unique;
+  }
+
+  void optimize_vertex_cache(GLuint *indices, GLsizei count, GLsizei numvertices, GLsizei cachesize)
+  {
+    count -= count % 3;
+    if (count == 0)
+      return;
+
+    // triangles adjacent to each vertex
+    std::vector<GLuint> first(numvertices + 1, 0);
+    for (GLsizei i = 0; i < count; ++i)
+      ++first[indices[i] + 1];
+    for (GLsizei v = 0; v < numvertices; ++v)
+      first[v + 1] += first[v];
+
+    std::vector<GLuint> adjacency(count);
+    std::vector<GLuint> fill(first.begin(), first.end() - 1);
+    for (GLsizei i = 0; i < count; ++i)
+      adjacency[fill[indices[i]]++] = GLuint(i / 3);
+
+    // triangles left to emit per vertex
+    std::vector<GLint> live(numvertices);
+    for (GLsizei v = 0; v < numvertices; ++v)
+      live[v] = GLint(first[v + 1] - first[v]);
+
+    std::vector<GLint> timestamp(numvertices, 0);
+    std::vector<bool> emitted(count / 3, false);
+
+    std::vector<GLuint> output;
+    output.reserve(count);
+    std::vector<GLuint> deadend;
+    std::vector<GLuint> candidates;
+
+    GLint time = cachesize + 1;
+    GLsizei cursor = 0;
+    GLint fan = 0;
+
+    while (fan >= 0)
+    {
+      // emit the triangles around the fanning vertex
+      candidates.clear();
+      for (GLuint a = first[fan]; a < first[fan + 1]; ++a)
+      {
+        GLuint t = adjacency[a];
+        if (emitted[t])
+          continue;
+
+        for (int k = 0; k < 3; ++k)
+        {
+          GLuint v = indices[3 * t + k];
+          output.push_back(v);
+          deadend.push_back(v);
+          candidates.push_back(v);
+          --live[v];
+
+          if (time - timestamp[v] > cachesize)
+            timestamp[v] = time++;
+        }
+        emitted[t] = true;
+      }
+
+      // next fanning vertex: the one staying longest in cache after its remaining triangles
+      fan = -1;
+      GLint best = -1;
+      for (GLuint v : candidates)
+      {
+        if (live[v] <= 0)
+          continue;
+
+        GLint priority = 0;
+        if (time - timestamp[v] + 2 * live[v] <= cachesize)
+          priority = time - timestamp[v];
+
+        if (priority > best)
+        {
+          best = priority;
+          fan = GLint(v);
+        }
+      }
+
+      // dead end, go back to a recently used vertex or the next one in input order
+      while (fan < 0 && !deadend.empty())
+      {
+        GLuint v = deadend.back();
+        deadend.pop_back();
+        if (live[v] > 0)
+          fan = GLint(v);
+      }
+
+      for (; fan < 0 && cursor < numvertices; ++cursor)
+        if (live[cursor] > 0)
+          fan = GLint(cursor);
+    }
+
+    std::memcpy(indices, output.data(), output.size() * sizeof(GLuint));
+  }
+
+  GLsizei optimize_vertex_fetch(void *vertices, GLsizei numvertices, GLsizei stride, GLuint *indices, GLsizei count)
+  {
+    const GLuint unused = ~0u;
+    std::vector<GLuint> remap(numvertices, unused);
+
+    GLuint next = 0;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+      GLuint &v = remap[indices[i]];
+      if (v == unused)
+        v = next++;
+      indices[i] = v;
+    }
+
+    char *data = static_cast<char *>(vertices);
+    std::vector<char> copy(data, data + size_t(numvertices) * stride);
+    for (GLsizei v = 0; v < numvertices; ++v)
+      if (remap[v] != unused)
+        std::memcpy(data + size_t(remap[v]) * stride, copy.data() + size_t(v) * stride, stride);
+
+    return GLsizei(next);
+  }
+
+  float average_cache_miss_ratio(const GLuint *indices, GLsizei count, GLsizei numvertices, GLsizei cachesize)
+  {
+    if (count < 3)
+      return 0.f;
+
+    // fifo cache, a vertex is in cache while less than cachesize misses happened since it was loaded
+    std::vector<GLsizei> loaded(numvertices, -cachesize - 1);
+    GLsizei misses = 0;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+      if (misses - loaded[indices[i]] > cachesize)
+        loaded[indices[i]] = misses++;
+    }
+
+    return float(misses) / float(count / 3);
+  }
+
+  GLsizei optimize_mesh(std::vector<char> &vertices, GLsizei stride, std::vector<GLuint> &indices, GLsizei cachesize)
+  {
+    GLsizei numvertices = GLsizei(vertices.size() / stride);
+    GLsizei count = GLsizei(indices.size());
+
+    // duplicates point to their first occurrence and are dropped by the fetch stage
+    std::vector<GLuint> remap;
+    weld_vertices(vertices.data(), numvertices, stride, remap);
+    for (auto &index : indices)
+      index = remap[index];
+
+    optimize_vertex_cache(indices.data(), count, numvertices, cachesize);
+    numvertices = optimize_vertex_fetch(vertices.data(), numvertices, stride, indices.data(), count);
+
+    vertices.resize(size_t(numvertices) * stride);
+    return numvertices;
+  }
+
+}
@@ -0,0 +1,232 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/utils/quantize.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// without -mf16c the F16C path is compiled for its own target and picked at runtime
+#if !defined(__F16C__) && defined(__SSE2__) && defined(__GNUC__)
+#define GLTOOLBOX_F16C_DISPATCH
+#endif
+
+namespace gltoolbox
+{
+  uint16_t float_to_half(float value)
+  {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    uint32_t abs = bits & 0x7fffffff;
+
+    // inf and nan
+    if (abs >= 0x7f800000)
+      return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+
+    // rounds above the largest half
+    if (abs >= 0x477ff000)
+      return sign | 0x7c00;
+
+    // subnormal half, the float unit does the rounding
+    if (abs < 0x38800000)
+    {
+      float magnitude;
+      std::memcpy(&magnitude, &abs, sizeof(magnitude));
+      return sign | uint16_t(std::nearbyint(magnitude * 16777216.f));
+    }
+
+    // rebias the exponent and round the mantissa to nearest even
+    uint32_t h = abs - 0x38000000;
+    h += 0xfff + ((h >> 13) & 1);
+    return sign | uint16_t(h >> 13);
+  }
+
+  float half_to_float(uint16_t value)
+  {
+    uint32_t sign = uint32_t(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t mantissa = value & 0x3ff;
+
+    if (exponent == 0)
+    {
+      float magnitude = float(mantissa) / 16777216.f;
+      return sign ? -magnitude : magnitude;
+    }
+
+    uint32_t bits = sign | (exponent == 31 ? 0x7f800000 : (exponent + 112) << 23) | (mantissa << 13);
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+
+  int16_t float_to_snorm16(float value)
+  {
+    return int16_t(std::nearbyint(std::clamp(value, -1.f, 1.f) * 32767.f));
+  }
+
+  uint32_t pack_snorm_2_10_10_10(float x, float y, float z, float w)
+  {
+    auto snorm = [](float v, float scale, uint32_t mask) {
+      return uint32_t(int32_t(std::nearbyint(std::clamp(v, -1.f, 1.f) * scale))) & mask;
+    };
+
+    return snorm(x, 511.f, 0x3ff) | (snorm(y, 511.f, 0x3ff) << 10) | (snorm(z, 511.f, 0x3ff) << 20) | (snorm(w, 1.f, 0x3) << 30);
+  }
+
+#if defined(__F16C__) || defined(GLTOOLBOX_F16C_DISPATCH)
+  namespace
+  {
+    // converts the multiple of 8 part of the array, returns the number of converted values
+#if defined(GLTOOLBOX_F16C_DISPATCH)
+    __attribute__((target("avx,f16c")))
+#endif
+    size_t quantize_half_f16c(const float *src, uint16_t *dst, size_t count)
+    {
+      size_t i = 0;
+      for (; i + 8 <= count; i += 8)
+      {
+        __m256 v = _mm256_loadu_ps(src + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+      }
+      return i;
+    }
+
+    bool has_f16c()
+    {
+#if defined(GLTOOLBOX_F16C_DISPATCH)
+      static const bool supported = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+      return supported;
+#else
+      return true;
+#endif
+    }
+  }
+#endif
+
+  void quantize_half(const float *src, uint16_t *dst, size_t count)
+  {
+    size_t i = 0;
+#if defined(__F16C__) || defined(GLTOOLBOX_F16C_DISPATCH)
+    if (has_f16c())
+      i = quantize_half_f16c(src, dst, count);
+#endif
+    for (; i < count; ++i)
+      dst[i] = float_to_half(src[i]);
+  }
+
+  void quantize_snorm16(const float *src, int16_t *dst, size_t count)
+  {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128 lo = _mm_set1_ps(-1.f);
+    const __m128 hi = _mm_set1_ps(1.f);
+    const __m128 scale = _mm_set1_ps(32767.f);
+    for (; i + 8 <= count; i += 8)
+    {
+      // clamp, scale and round (default rounding mode is to nearest), then saturate to 16 bits
+      __m128 a = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i), lo), hi), scale);
+      __m128 b = _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + i + 4), lo), hi), scale);
+      __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+    }
+#endif
+    for (; i < count; ++i)
+      dst[i] = float_to_snorm16(src[i]);
+  }
+
+  void quantize_normals(const float *src, uint32_t *dst, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+      dst[i] = pack_snorm_2_10_10_10(src[3 * i], src[3 * i + 1], src[3 * i + 2]);
+  }
+
+  namespace
+  {
+    // converts the components of each vertex, padding the 3 component ones with zeros
+    template <typename T, typename Convert>
+    PackedAttribute pack(const float *src, GLsizei count, GLint size, GLenum type, GLboolean normalized, Convert convert)
+    {
+      GLint padded = (size == 3) ? 4 : size;
+
+      std::vector<float> staging;
+      if (padded != size)
+      {
+        staging.assign(size_t(count) * padded, 0.f);
+        for (GLsizei v = 0; v < count; ++v)
+          std::copy(src + size_t(v) * size, src + size_t(v + 1) * size, staging.begin() + size_t(v) * padded);
+        src = staging.data();
+      }
+
+      PackedAttribute packed;
+      packed.data.resize(size_t(count) * padded * sizeof(T));
+      packed.count = count;
+      packed.format = {size, type, normalized, GLsizei(padded * sizeof(T)), 0};
+
+      convert(src, reinterpret_cast<T *>(packed.data.data()), size_t(count) * padded);
+      return packed;
+    }
+  }
+
+  PackedAttribute pack_half(const float *src, GLsizei count, GLint size)
+  {
+    return pack<uint16_t>(src, count, size, GL_HALF_FLOAT, GL_FALSE, quantize_half);
+  }
+
+  PackedAttribute pack_snorm16(const float *src, GLsizei count, GLint size)
+  {
+    return pack<int16_t>(src, count, size, GL_SHORT, GL_TRUE, quantize_snorm16);
+  }
+
+  PackedAttribute pack_normals(const float *src, GLsizei count)
+  {
+    PackedAttribute packed;
+    packed.data.resize(size_t(count) * sizeof(uint32_t));
+    packed.count = count;
+    packed.format = {4, GL_INT_2_10_10_10_REV, GL_TRUE, GLsizei(sizeof(uint32_t)), 0};
+
+    quantize_normals(src, reinterpret_cast<uint32_t *>(packed.data.data()), size_t(count));
+    return packed;
+  }
+
+  bool add_packed_attribute(VertexArray &vao, const std::string &name, const PackedAttribute &attribute,
+                            GLenum usage, GLuint divisor)
+  {
+    const VertexArray::AttributeFormat &format = attribute.format;
+
+    auto buffer = std::make_shared<Buffer>(GL_ARRAY_BUFFER, format.stride, usage);
+    buffer->upload(const_cast<char *>(attribute.data.data()), attribute.count);
+
+    return vao.add_attribute(name, buffer, attribute.count, format.size, format.type, format.stride, format.offset,
+                             format.normalized, divisor);
+  }
+}
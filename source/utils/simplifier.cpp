@@ -0,0 +1,314 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/utils/simplifier.h>
+#include <gltoolbox/utils/meshoptimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_set>
+
+namespace gltoolbox
+{
+  namespace
+  {
+    // symmetric 4x4 matrix of the squared distances to a set of area weighted planes
+    struct Quadric
+    {
+      double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+      double w = 0;
+
+      void add_plane(double a, double b, double c, double d, double weight)
+      {
+        a2 += weight * a * a, ab += weight * a * b, ac += weight * a * c, ad += weight * a * d;
+        b2 += weight * b * b, bc += weight * b * c, bd += weight * b * d;
+        c2 += weight * c * c, cd += weight * c * d;
+        d2 += weight * d * d;
+        w += weight;
+      }
+
+      void add(const Quadric &q)
+      {
+        a2 += q.a2, ab += q.ab, ac += q.ac, ad += q.ad;
+        b2 += q.b2, bc += q.bc, bd += q.bd;
+        c2 += q.c2, cd += q.cd;
+        d2 += q.d2;
+        w += q.w;
+      }
+
+      // mean squared distance of p to the planes
+      double eval(const float *p) const
+      {
+        if (w == 0)
+          return 0;
+
+        double x = p[0], y = p[1], z = p[2];
+        double e = a2 * x * x + b2 * y * y + c2 * z * z + d2 +
+                   2 * (ab * x * y + ac * x * z + ad * x + bc * y * z + bd * y + cd * z);
+        return std::max(e / w, 0.0);
+      }
+    };
+
+    struct Collapse
+    {
+      GLuint from;
+      GLuint to;
+      double cost;
+    };
+
+    inline const float *position(const float *positions, GLsizei stride, GLuint v)
+    {
+      return reinterpret_cast<const float *>(reinterpret_cast<const char *>(positions) + size_t(v) * stride);
+    }
+
+    void normal(const float *a, const float *b, const float *c, double *n)
+    {
+      double u[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+      double v[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+      n[0] = u[1] * v[2] - u[2] * v[1];
+      n[1] = u[2] * v[0] - u[0] * v[2];
+      n[2] = u[0] * v[1] - u[1] * v[0];
+    }
+
+    inline uint64_t edge_key(GLuint a, GLuint b) { return (uint64_t(a) << 32) | b; }
+  }
+
+  std::vector<GLuint> simplify(const GLuint *indices, GLsizei count,
+                               const float *positions, GLsizei numvertices, GLsizei stride,
+                               GLsizei targetcount, float maxerror, float *error)
+  {
+    std::vector<GLuint> result(indices, indices + (count - count % 3));
+    double worst = 0;
+
+    // plane quadrics of the triangles
+    std::vector<Quadric> quadrics(numvertices);
+    for (size_t t = 0; t < result.size(); t += 3)
+    {
+      const float *p0 = position(positions, stride, result[t]);
+      double n[3];
+      normal(p0, position(positions, stride, result[t + 1]), position(positions, stride, result[t + 2]), n);
+
+      double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      if (length == 0)
+        continue;
+
+      Quadric q;
+      q.add_plane(n[0] / length, n[1] / length, n[2] / length, -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]) / length, 0.5 * length);
+      for (int k = 0; k < 3; ++k)
+        quadrics[result[t + k]].add(q);
+    }
+
+    // vertices on an edge used by a single triangle are locked
+    std::vector<bool> border(numvertices, false);
+    {
+      std::unordered_set<uint64_t> edges;
+      for (size_t t = 0; t < result.size(); t += 3)
+        for (int k = 0; k < 3; ++k)
+          edges.insert(edge_key(result[t + k], result[t + (k + 1) % 3]));
+
+      for (uint64_t e : edges)
+        if (edges.find((e << 32) | (e >> 32)) == edges.end())
+          border[e >> 32] = border[e & 0xffffffff] = true;
+    }
+
+    double limit = double(maxerror) * double(maxerror);
+
+    std::vector<GLuint> first(numvertices + 1);
+    std::vector<GLuint> adjacency;
+    std::vector<uint64_t> edges;
+    std::vector<Collapse> collapses;
+    std::vector<GLuint> remap(numvertices);
+    std::vector<bool> touched(numvertices);
+
+    // each pass performs the cheapest independent collapses
+    while (GLsizei(result.size()) > targetcount)
+    {
+      // triangles around each vertex
+      std::fill(first.begin(), first.end(), 0);
+      for (GLuint v : result)
+        ++first[v + 1];
+      for (GLsizei v = 0; v < numvertices; ++v)
+        first[v + 1] += first[v];
+
+      adjacency.resize(result.size());
+      std::vector<GLuint> fill(first.begin(), first.end() - 1);
+      for (size_t i = 0; i < result.size(); ++i)
+        adjacency[fill[result[i]]++] = GLuint(i / 3);
+
+      // unique edges and the cheapest direction to collapse them
+      edges.clear();
+      for (size_t t = 0; t < result.size(); t += 3)
+        for (int k = 0; k < 3; ++k)
+        {
+          GLuint a = result[t + k], b = result[t + (k + 1) % 3];
+          edges.push_back(edge_key(std::min(a, b), std::max(a, b)));
+        }
+      std::sort(edges.begin(), edges.end());
+      edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+      collapses.clear();
+      for (uint64_t e : edges)
+      {
+        GLuint a = GLuint(e >> 32), b = GLuint(e & 0xffffffff);
+        Quadric q = quadrics[a];
+        q.add(quadrics[b]);
+
+        Collapse best = {a, b, 1e300};
+        if (!border[a])
+          best = {a, b, q.eval(position(positions, stride, b))};
+        if (!border[b])
+        {
+          double cost = q.eval(position(positions, stride, a));
+          if (cost < best.cost)
+            best = {b, a, cost};
+        }
+
+        if (best.cost <= limit)
+          collapses.push_back(best);
+      }
+
+      std::sort(collapses.begin(), collapses.end(), [](const Collapse &x, const Collapse &y) { return x.cost < y.cost; });
+
+      for (GLsizei v = 0; v < numvertices; ++v)
+        remap[v] = GLuint(v);
+      std::fill(touched.begin(), touched.end(), false);
+
+      GLsizei remaining = GLsizei(result.size());
+      size_t performed = 0;
+      for (const Collapse &c : collapses)
+      {
+        if (remaining <= targetcount)
+          break;
+        if (touched[c.from] || touched[c.to])
+          continue;
+
+        // reject collapses flipping a triangle around the removed vertex
+        bool flips = false;
+        GLsizei removed = 0;
+        for (GLuint a = first[c.from]; a < first[c.from + 1] && !flips; ++a)
+        {
+          const GLuint *tri = &result[3 * adjacency[a]];
+          if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+          {
+            ++removed;
+            continue;
+          }
+
+          const float *p[3], *moved[3];
+          for (int k = 0; k < 3; ++k)
+          {
+            p[k] = position(positions, stride, tri[k]);
+            moved[k] = (tri[k] == c.from) ? position(positions, stride, c.to) : p[k];
+          }
+
+          double n0[3], n1[3];
+          normal(p[0], p[1], p[2], n0);
+          normal(moved[0], moved[1], moved[2], n1);
+          flips = (n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2]) <= 0;
+        }
+
+        if (flips)
+          continue;
+
+        // the neighbourhood of the collapse is frozen until the next pass
+        for (GLuint a = first[c.from]; a < first[c.from + 1]; ++a)
+          for (int k = 0; k < 3; ++k)
+            touched[result[3 * adjacency[a] + k]] = true;
+
+        remap[c.from] = c.to;
+        quadrics[c.to].add(quadrics[c.from]);
+        worst = std::max(worst, c.cost);
+        remaining -= 3 * removed;
+        ++performed;
+      }
+
+      if (performed == 0)
+        break;
+
+      // apply the collapses and drop the degenerate triangles
+      size_t write = 0;
+      for (size_t t = 0; t < result.size(); t += 3)
+      {
+        GLuint a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+        if (a == b || b == c || a == c)
+          continue;
+        result[write++] = a;
+        result[write++] = b;
+        result[write++] = c;
+      }
+      result.resize(write);
+    }
+
+    if (error)
+      *error = float(std::sqrt(worst));
+
+    return result;
+  }
+
+  std::vector<MeshLod> build_lods(const std::vector<GLuint> &indices,
+                                  const float *positions, GLsizei numvertices, GLsizei stride,
+                                  std::vector<GLuint> &lodindices, GLsizei levels, float ratio)
+  {
+    std::vector<MeshLod> lods;
+    lodindices.clear();
+
+    std::vector<GLuint> current = indices;
+    float error = 0.f;
+    for (GLsizei level = 0; level < levels && !current.empty(); ++level)
+    {
+      lods.push_back({GLuint(lodindices.size()), GLsizei(current.size()), error});
+      lodindices.insert(lodindices.end(), current.begin(), current.end());
+
+      GLsizei target = GLsizei(float(current.size()) * ratio) / 3 * 3;
+      float collapse = 0.f;
+      std::vector<GLuint> next = simplify(current.data(), GLsizei(current.size()), positions, numvertices, stride, target, 1e30f, &collapse);
+
+      // stop when the mesh cannot be reduced much further
+      if (next.size() * 20 > current.size() * 19)
+        break;
+
+      optimize_vertex_cache(next.data(), GLsizei(next.size()), numvertices);
+      current = std::move(next);
+      error += collapse; // deviations add up along the chain
+    }
+
+    return lods;
+  }
+
+  size_t select_lod(const std::vector<MeshLod> &lods, float distance, float fovy, float height, float pixelerror)
+  {
+    // object units to pixels at that distance
+    float scale = height / (2.f * std::max(distance, 1e-6f) * std::tan(0.5f * fovy));
+
+    size_t selected = 0;
+    for (size_t l = 0; l < lods.size(); ++l)
+      if (lods[l].error * scale <= pixelerror)
+        selected = l;
+
+    return selected;
+  }
+}
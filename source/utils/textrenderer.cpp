@@ -27,11 +27,12 @@
 #include <gltoolbox/utils/textrenderer.h>
 using namespace gltoolbox;
 
+#include <cstddef>
 #include <iostream>
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
-#define BUFFSIZE 100
+#define BUFFSIZE 1024
 
 // Shaders //-------------------------------------------------------//
 const std::string vShader = "#version 450 core \n"
@@ -63,12 +64,9 @@ const std::string fShader = "#version 450 core \n"
 std::string TextRenderer::charlist = " !\"#$%&\'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~";
 int TextRenderer::padding = 4;
 
-TextRenderer::TextRenderer(bool doInit)
-    : mCurrSize(1.f), mCurrRGB{0.f, 0.f, 0.f}, mCurrFont(""), mIsInit(false), mAtlas(GL_TEXTURE_2D)
+TextRenderer::TextRenderer(bool doInit, ProgramCache *cache)
+    : mCurrSize(1.f), mCurrRGB{0.f, 0.f, 0.f}, mCurrFont(""), mIsInit(false), mCache(cache), mAtlas(GL_TEXTURE_2D)
 {
-  mPos.resize(4 * BUFFSIZE, 0.f);
-  mTex.resize(4 * BUFFSIZE, 0.f);
-
   if (doInit)
     init();
 }
@@ -109,48 +107,35 @@ void TextRenderer::draw(const std::string &text, float x, float y,
   //texture
   mAtlas.bind();
   mPrg.enable_samplers();
-  //attributes
+  //geometry, the vertex format is recorded in the vao
   mVao.bind();
-  mVao.enable_attributes(mPrg.attributes());
 
-  int i = 0;
-  while (i < text.size())
+  mGlyphs->begin(mVao);
+  for (const char &character : text)
   {
-    for (int j = 0; j < BUFFSIZE; ++j)
-    {
-      auto it = font.characterlist.find(text.at(i));
-      if (it == font.characterlist.end())
-        it--;
-
-      //compute vertex and texture coords
-      const Character &c = it->second;
-      mPos[4 * j + 0] = advance + float(c.bearingX) * scaleX;
-      mPos[4 * j + 1] = (-float(c.height) + float(c.bearingY)) * scaleY;
-      mPos[4 * j + 2] = float(c.width) * scaleX;
-      mPos[4 * j + 3] = float(c.height) * scaleY;
-
-      mTex[4 * j + 0] = (c.texX - 1) * scaleT;
-      mTex[4 * j + 1] = (c.texY - 1) * scaleT;
-      mTex[4 * j + 2] = (c.width + 2) * scaleT;
-      mTex[4 * j + 3] = (c.height + 2) * scaleT;
-
-      advance += (float(c.advance >> 6) - 2) * scaleX;
-
-      ++i;
-      if (i >= text.size())
-        break;
-    }
-
-    //upload data to gpu
-    mVao.attribute_buffer("vPos")->upload(mPos.data(), mPos.size());
-    mVao.attribute_buffer("vTex")->upload(mTex.data(), mTex.size());
-
-    //draw
-    mVao.draw_elements(text.size());
+    auto it = font.characterlist.find(character);
+    if (it == font.characterlist.end())
+      it--;
+
+    //compute vertex and texture coords
+    const Character &c = it->second;
+    Glyph &glyph = mGlyphs->push();
+    glyph.pos[0] = advance + float(c.bearingX) * scaleX;
+    glyph.pos[1] = (-float(c.height) + float(c.bearingY)) * scaleY;
+    glyph.pos[2] = float(c.width) * scaleX;
+    glyph.pos[3] = float(c.height) * scaleY;
+
+    glyph.tex[0] = (c.texX - 1) * scaleT;
+    glyph.tex[1] = (c.texY - 1) * scaleT;
+    glyph.tex[2] = (c.width + 2) * scaleT;
+    glyph.tex[3] = (c.height + 2) * scaleT;
+
+    advance += (float(c.advance >> 6) - 2) * scaleX;
   }
+  //draw the glyphs still pending
+  mGlyphs->end();
 
   //cleanup
-  mVao.disable_attributes(mPrg.attributes());
   mVao.unbind();
   mAtlas.unbind();
   mPrg.unuse();
@@ -246,9 +231,14 @@ void TextRenderer::init()
   mAtlas.set_format(GL_RED);
 
   //setup program
-  mPrg.attach_shader(vShader, GL_VERTEX_SHADER);
-  mPrg.attach_shader(fShader, GL_FRAGMENT_SHADER);
-  mPrg.link();
+  if (mCache)
+    mPrg.link(*mCache, {{GL_VERTEX_SHADER, vShader}, {GL_FRAGMENT_SHADER, fShader}});
+  else
+  {
+    mPrg.attach_shader(vShader, GL_VERTEX_SHADER);
+    mPrg.attach_shader(fShader, GL_FRAGMENT_SHADER);
+    mPrg.link();
+  }
 
   //add uniforms and inputs
   mPrg.add_uniform<std::array<float, 3>>("rgb");
@@ -267,8 +257,11 @@ void TextRenderer::init()
   indices = {0, 1, 2, 0, 2, 3};
   mVao.set_index_buffer<uint8_t>(GL_TRIANGLES, indices.data(), indices.size(), GL_STATIC_DRAW);
 
-  mVao.add_attribute<float>("vPos", mPos.data(), mPos.size(), 4, GL_FLOAT, 0, 0, GL_DYNAMIC_DRAW, GL_FALSE, 1);
-  mVao.add_attribute<float>("vTex", mTex.data(), mTex.size(), 4, GL_FLOAT, 0, 0, GL_DYNAMIC_DRAW, GL_FALSE, 1);
+  VertexLayout glyph(sizeof(Glyph));
+  glyph.add<float>("vPos", 4, offsetof(Glyph, pos)).add<float>("vTex", 4, offsetof(Glyph, tex));
+  mGlyphs = std::make_shared<InstanceStream<Glyph>>(BUFFSIZE);
+  mGlyphs->attach(mVao, glyph);
+  mVao.enable_attributes(mPrg);
 
   mIsInit = true;
 }
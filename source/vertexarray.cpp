@@ -25,10 +25,13 @@
   */
 
 #include <gltoolbox/vertexarray.h>
+#include <gltoolbox/program.h>
 using namespace gltoolbox;
 
+#include <algorithm>
+
 VertexArray::VertexArray()
-    : mId(0), mOwned(false)
+    : mId(0), mOwned(false), mRevision(1), mCurrent(nullptr), mPairedWith(nullptr), mBoundIndices(0)
 {
   create();
 }
@@ -41,6 +44,16 @@ VertexArray::VertexArray(VertexArray &&temp)
   mId = temp.mId;
   mOwned = temp.mOwned;
 
+  mIndices = std::move(temp.mIndices);
+  mAttributes = std::move(temp.mAttributes);
+  mTables = std::move(temp.mTables);
+  mCurrent = temp.mCurrent; // table nodes are moved along with the map
+  mPairedWith = nullptr;
+  mRevision = temp.mRevision + 1; // record the format again on next bind
+  mBoundIndices = 0;
+
+  temp.mCurrent = nullptr;
+
   // clear the information from temp
   temp.mId = 0;
   temp.mOwned = false;
@@ -51,6 +64,38 @@ VertexArray::~VertexArray()
   destroy();
 }
 
+void VertexArray::bind() const
+{
+  glBindVertexArray(mId);
+
+  if (mCurrent && mCurrent->revision != mRevision)
+  {
+    resolve(*mCurrent);
+    record_format(*mCurrent);
+  }
+  else
+  {
+    // re-attach buffers whose store or offset changed since the format was recorded
+    for (auto &binding : mBindings)
+    {
+      const AttributeBuffer &attr = *binding.attribute;
+      GLintptr offset = binding_offset(attr, binding.stride);
+      if (attr.buffer->generation() != binding.generation || offset != binding.offset)
+      {
+        glVertexArrayVertexBuffer(mId, binding.index, attr.buffer->id(), offset, binding.stride);
+        binding.generation = attr.buffer->generation();
+        binding.offset = offset;
+      }
+    }
+  }
+
+  if (mIndices.buffer && mIndices.buffer->generation() != mBoundIndices)
+  {
+    mBoundIndices = mIndices.buffer->generation();
+    glVertexArrayElementBuffer(mId, mIndices.buffer->id());
+  }
+}
+
 void VertexArray::draw_arrays(GLenum mode, GLint first, GLsizei count) const
 {
   glDrawArrays(mode, first, count);
@@ -63,20 +108,123 @@ void VertexArray::draw_arrays(GLenum mode, GLint first, GLsizei count, GLsizei i
 
 void VertexArray::draw_elements() const
 {
-  mIndices.buffer->bind();
-  glDrawElements(mIndices.mode, mIndices.count, mIndices.type, (GLvoid *)0);
+  glDrawElements(mIndices.mode, mIndices.count, mIndices.type, (GLvoid *)index_offset());
 }
 
 void VertexArray::draw_elements(GLsizei inum) const
 {
-  mIndices.buffer->bind();
-  glDrawElementsInstanced(mIndices.mode, mIndices.count, mIndices.type, (GLvoid *)0, inum);
+  glDrawElementsInstanced(mIndices.mode, mIndices.count, mIndices.type, (GLvoid *)index_offset(), inum);
 }
 
 void VertexArray::draw_elements(GLuint start, GLuint end) const
 {
-  mIndices.buffer.get()->bind();
-  glDrawRangeElements(mIndices.mode, start, end, end - start, mIndices.type, (GLvoid *)0);
+  glDrawRangeElements(mIndices.mode, start, end, end - start, mIndices.type, (GLvoid *)index_offset());
+}
+
+void VertexArray::draw_elements_base_vertex(GLuint start, GLuint end, GLint basevertex) const
+{
+  glDrawRangeElementsBaseVertex(mIndices.mode, start, end, end - start, mIndices.type, (GLvoid *)index_offset(), basevertex);
+}
+
+void VertexArray::draw_elements_base_instance(GLsizei inum, GLuint baseinstance) const
+{
+  glDrawElementsInstancedBaseInstance(mIndices.mode, mIndices.count, mIndices.type, (GLvoid *)index_offset(), inum, baseinstance);
+}
+
+void VertexArray::draw_sub_elements(GLuint firstindex, GLsizei count, GLint basevertex) const
+{
+  GLintptr offset = index_offset() + GLintptr(firstindex) * VertexLayout::attribute_size(1, mIndices.type);
+  glDrawElementsBaseVertex(mIndices.mode, count, mIndices.type, (GLvoid *)offset, basevertex);
+}
+
+void VertexArray::multi_draw_sub_elements(const GLuint *firstindices, const GLsizei *counts, GLsizei drawcount) const
+{
+  GLintptr base = index_offset();
+  GLsizei size = VertexLayout::attribute_size(1, mIndices.type);
+
+  mOffsets.resize(drawcount);
+  for (GLsizei i = 0; i < drawcount; ++i)
+    mOffsets[i] = (const GLvoid *)(base + GLintptr(firstindices[i]) * size);
+
+  glMultiDrawElements(mIndices.mode, counts, mIndices.type, mOffsets.data(), drawcount);
+}
+
+void VertexArray::multi_draw_elements_base_vertex(const GLsizei *counts, const GLvoid *const *offsets,
+                                                  const GLint *basevertices, GLsizei drawcount) const
+{
+  glMultiDrawElementsBaseVertex(mIndices.mode, counts, mIndices.type, offsets, drawcount, basevertices);
+}
+
+void VertexArray::multi_draw_elements_indirect(const Buffer &commands, GLsizei drawcount, GLsizei first) const
+{
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.id());
+  glMultiDrawElementsIndirect(mIndices.mode, mIndices.type, (GLvoid *)(GLintptr(first) * commands.element_size()),
+                              drawcount, commands.element_size());
+}
+
+void VertexArray::multi_draw_arrays_indirect(GLenum mode, const Buffer &commands, GLsizei drawcount, GLsizei first) const
+{
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.id());
+  glMultiDrawArraysIndirect(mode, (GLvoid *)(GLintptr(first) * commands.element_size()), drawcount, commands.element_size());
+}
+
+void VertexArray::multi_draw_elements_indirect_count(const Buffer &commands, const Buffer &drawcount, GLsizei maxdrawcount,
+                                                     GLintptr countoffset) const
+{
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.id());
+  glBindBuffer(GL_PARAMETER_BUFFER, drawcount.id());
+  glMultiDrawElementsIndirectCount(mIndices.mode, mIndices.type, nullptr, countoffset, maxdrawcount, commands.element_size());
+}
+
+void VertexArray::set_narrowed_index_buffer(GLenum mode, const GLuint *indices, GLsizei count, GLsizei numvertices, GLenum usage)
+{
+  switch (index_type(numvertices))
+  {
+  case GL_UNSIGNED_BYTE:
+  {
+    std::vector<GLubyte> narrowed(indices, indices + count);
+    set_index_buffer(mode, narrowed.data(), count, usage);
+    break;
+  }
+  case GL_UNSIGNED_SHORT:
+  {
+    std::vector<GLushort> narrowed(indices, indices + count);
+    set_index_buffer(mode, narrowed.data(), count, usage);
+    break;
+  }
+  default:
+    set_index_buffer(mode, const_cast<GLuint *>(indices), count, usage);
+    break;
+  }
+}
+
+GLenum VertexArray::index_type(GLsizei numvertices)
+{
+  if (numvertices <= 0x100)
+    return GL_UNSIGNED_BYTE;
+  if (numvertices <= 0x10000)
+    return GL_UNSIGNED_SHORT;
+  return GL_UNSIGNED_INT;
+}
+
+void VertexArray::set_index_buffer(GLenum mode, const std::shared_ptr<Buffer> &buffer, GLsizei count, GLenum type)
+{
+  mIndices.buffer = buffer;
+  mIndices.range = BufferRange();
+
+  mIndices.count = count;
+  mIndices.mode = mode;
+  mIndices.type = type;
+}
+
+void VertexArray::set_index_buffer(GLenum mode, const BufferRange &range, GLsizei count, GLenum type)
+{
+  mIndices.buffer = range.buffer();
+  mIndices.range = range;
+
+  mIndices.count = count;
+  mIndices.mode = mode;
+  mIndices.type = type;
 }
 
 bool VertexArray::has_index_buffer() const
@@ -97,48 +245,202 @@ bool VertexArray::has_attribute(const std::string &name) const
   return false;
 }
 
-void VertexArray::enable_attribute(const std::string &name, GLint loc) const
+bool VertexArray::add_attribute(const std::string &name, const std::shared_ptr<Buffer> &buffer, GLsizei count,
+                                GLsizei size, GLenum type, GLsizei stride, GLsizei offset,
+                                GLboolean normalized, GLuint divisor)
 {
-  if (has_attribute(name))
+  auto search = mAttributes.find(name);
+  if (search == mAttributes.end())
   {
-    const auto &format = attribute_format(name);
-    const auto &divisor = attribute_divisor(name);
-
-    mAttributes.at(name).buffer->bind();
-    glEnableVertexAttribArray(loc);
-    glVertexAttribPointer(loc, format.size, format.type, format.normalized, format.stride, 0);
-    if (divisor > 0)
-      glVertexAttribDivisor(loc, divisor);
+    AttributeBuffer attr;
+    attr.buffer = buffer;
+
+    attr.format = {size, type, normalized, stride, GLuint(offset)};
+    attr.count = count;
+    attr.divisor = divisor;
+
+    mAttributes.insert({name, std::move(attr)});
+    ++mRevision;
+
+    return true;
+  }
+  return false;
+}
+
+bool VertexArray::add_attribute(const std::string &name, const BufferRange &range, GLsizei count,
+                                GLsizei size, GLenum type, GLsizei stride, GLsizei offset,
+                                GLboolean normalized, GLuint divisor)
+{
+  if (add_attribute(name, range.buffer(), count, size, type, stride, offset, normalized, divisor))
+  {
+    mAttributes.at(name).range = range;
+    return true;
+  }
+  return false;
+}
+
+bool VertexArray::add_vertices(const VertexLayout &layout, const std::shared_ptr<Buffer> &buffer, GLsizei count, GLuint divisor)
+{
+  bool success = true;
+  for (const auto &attr : layout.attributes())
+  {
+    bool added = add_attribute(attr.name, buffer, count, attr.size, attr.type, layout.stride(), attr.offset, attr.normalized, divisor);
+    if (added)
+      mAttributes.at(attr.name).format.integer = attr.integer;
+    success &= added;
   }
+
+  return success;
+}
+
+void VertexArray::enable_attribute(const std::string &name, GLint loc) const
+{
+  BindingTable &table = mTables[0];
+  table.locations[name] = loc;
+  table.revision = 0;
+
+  resolve(table);
+  record_format(table);
+  mPairedWith = nullptr;
 }
 
 void VertexArray::enable_attributes(const std::unordered_map<std::string, GLint> &attributes) const
 {
-  for (const auto &[name, loc] : attributes)
-    enable_attribute(name, loc);
+  // already paired with these attributes
+  if (mPairedWith == &attributes && mCurrent && mCurrent->revision == mRevision && mCurrent->locations.size() == attributes.size())
+    return;
+
+  BindingTable &table = mTables[0];
+  table.locations = attributes;
+
+  resolve(table);
+  record_format(table);
+  mPairedWith = &attributes;
 }
 
-void VertexArray::disable_attribute(const std::string &name, GLint loc) const
+void VertexArray::enable_attributes(const Program &program) const
 {
-  if (has_attribute(name))
+  BindingTable &table = mTables[program.generation()];
+
+  // already recorded in the vao
+  if (mCurrent == &table && table.revision == mRevision && table.locations.size() == program.attributes().size())
+    return;
+
+  if (table.revision != mRevision || table.locations.size() != program.attributes().size())
   {
-    glDisableVertexAttribArray(loc);
-    mAttributes.at(name).buffer->unbind();
+    table.locations = program.attributes();
+    resolve(table);
   }
+
+  record_format(table);
+  mPairedWith = nullptr;
+}
+
+void VertexArray::disable_attribute(const std::string &name, GLint loc) const
+{
+  glDisableVertexArrayAttrib(mId, loc);
+  if (!mCurrent)
+    return;
+
+  mCurrent->locations.erase(name);
+  resolve(*mCurrent);
+  record_format(*mCurrent);
+  mPairedWith = nullptr;
 }
 
 void VertexArray::disable_attributes(const std::unordered_map<std::string, GLint> &attributes) const
 {
   for (const auto &[name, loc] : attributes)
-    disable_attribute(name, loc);
+  {
+    glDisableVertexArrayAttrib(mId, loc);
+    if (mCurrent)
+      mCurrent->locations.erase(name);
+  }
+
+  if (!mCurrent)
+    return;
+
+  resolve(*mCurrent);
+  record_format(*mCurrent);
+  mPairedWith = nullptr;
+}
+
+void VertexArray::resolve(BindingTable &table) const
+{
+  table.attributes.clear();
+  for (const auto &[name, loc] : table.locations)
+  {
+    auto search = mAttributes.find(name);
+    if (loc < 0 || search == mAttributes.end() || !search->second.buffer)
+      continue;
+
+    table.attributes.push_back({GLuint(loc), &search->second});
+  }
+
+  std::sort(table.attributes.begin(), table.attributes.end(), [](const ResolvedAttribute &a, const ResolvedAttribute &b) {
+    return a.location < b.location;
+  });
+
+  table.revision = mRevision;
+}
+
+void VertexArray::record_format(BindingTable &table) const
+{
+  for (const auto &index : mEnabled)
+    glDisableVertexArrayAttrib(mId, index);
+  mEnabled.clear();
+  mBindings.clear();
+
+  for (const auto &[index, attribute] : table.attributes)
+  {
+    const AttributeBuffer &attr = *attribute;
+    const AttributeFormat &format = attr.format;
+
+    GLsizei stride = (format.stride > 0) ? format.stride : VertexLayout::attribute_size(format.size, format.type);
+    GLintptr offset = binding_offset(attr, stride);
+    GLuint relative = is_relative_offset(format, stride) ? format.offset : 0;
+
+    glEnableVertexArrayAttrib(mId, index);
+    if (format.integer)
+      glVertexArrayAttribIFormat(mId, index, format.size, format.type, relative);
+    else
+      glVertexArrayAttribFormat(mId, index, format.size, format.type, format.normalized, relative);
+    mEnabled.push_back(index);
+
+    // attributes interleaved in the same buffer share one binding
+    auto binding = std::find_if(mBindings.begin(), mBindings.end(), [&](const AttributeBinding &b) {
+      return b.attribute->buffer == attr.buffer && b.offset == offset && b.stride == stride && b.attribute->divisor == attr.divisor;
+    });
+
+    if (binding != mBindings.end())
+    {
+      glVertexArrayAttribBinding(mId, index, binding->index);
+      continue;
+    }
+
+    glVertexArrayAttribBinding(mId, index, index);
+    glVertexArrayVertexBuffer(mId, index, attr.buffer->id(), offset, stride);
+    glVertexArrayBindingDivisor(mId, index, attr.divisor);
+
+    mBindings.push_back({index, &attr, stride, attr.buffer->generation(), offset});
+  }
+
+  mCurrent = &table;
+}
+
+GLintptr VertexArray::binding_offset(const AttributeBuffer &attr, GLsizei stride)
+{
+  GLintptr offset = attr.range.is_valid() ? attr.range.offset() : 0;
+  if (!is_relative_offset(attr.format, stride))
+    offset += attr.format.offset;
+  return offset;
 }
 
 void VertexArray::create()
 {
   if (!mOwned || !is_valid())
   {
-    glCreateVertexArrays(1, &mId);
-    bind(); // this will actually trigger the buffer creation
+    glCreateVertexArrays(1, &mId); // vertex array object is created without binding it
     mOwned = true;
   }
 }
@@ -0,0 +1,261 @@
+/**
+  * This file is part of gltoolbox
+  *
+  * MIT License
+  *
+  * Copyright (c) 2021 Georges Nader
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  * copies of the Software, and to permit persons to whom the Software is
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in all
+  * copies or substantial portions of the Software.
+  *
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+  * SOFTWARE.
+  */
+
+#include <gltoolbox/vertexpuller.h>
+using namespace gltoolbox;
+
+#include <iostream>
+#include <sstream>
+
+VertexPuller::VertexPuller()
+    : mIndexBinding(0), mIndexType(GL_UNSIGNED_INT)
+{
+}
+
+VertexPuller::~VertexPuller()
+{
+}
+
+bool VertexPuller::add_stream(GLuint binding, const VertexLayout &layout, const std::shared_ptr<Buffer> &buffer)
+{
+  for (const auto &attribute : layout.attributes())
+    if (!is_supported(attribute.type))
+    {
+      std::cerr << "[VertexPuller::add_stream()] : attribute " << attribute.name << " has a type that cannot be fetched" << std::endl;
+      return false;
+    }
+
+  if (is_bound(binding))
+  {
+    std::cerr << "[VertexPuller::add_stream()] : binding " << binding << " is already used" << std::endl;
+    return false;
+  }
+
+  mStreams.push_back({binding, layout, buffer});
+  return true;
+}
+
+bool VertexPuller::set_index_buffer(GLuint binding, const std::shared_ptr<Buffer> &buffer, GLenum type)
+{
+  if (type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT && type != GL_UNSIGNED_INT)
+  {
+    std::cerr << "[VertexPuller::set_index_buffer()] : unsupported index type" << std::endl;
+    return false;
+  }
+
+  for (const auto &stream : mStreams)
+    if (stream.binding == binding)
+    {
+      std::cerr << "[VertexPuller::set_index_buffer()] : binding " << binding << " is used by a stream" << std::endl;
+      return false;
+    }
+
+  mIndexBinding = binding;
+  mIndices = buffer;
+  mIndexType = type;
+  return true;
+}
+
+bool VertexPuller::is_supported(GLenum type)
+{
+  switch (type)
+  {
+  case GL_FLOAT:
+  case GL_HALF_FLOAT:
+  case GL_INT:
+  case GL_UNSIGNED_INT:
+  case GL_SHORT:
+  case GL_UNSIGNED_SHORT:
+  case GL_BYTE:
+  case GL_UNSIGNED_BYTE:
+  case GL_INT_2_10_10_10_REV:
+  case GL_UNSIGNED_INT_2_10_10_10_REV:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool VertexPuller::is_bound(GLuint binding) const
+{
+  if (mIndices && mIndexBinding == binding)
+    return true;
+
+  for (const auto &stream : mStreams)
+    if (stream.binding == binding)
+      return true;
+
+  return false;
+}
+
+std::string VertexPuller::shader_source() const
+{
+  std::ostringstream src;
+  src << "#extension GL_ARB_shader_draw_parameters : require \n";
+
+  // one word array per buffer with byte addressed readers
+  auto declare = [&src](GLuint binding) {
+    src << "layout(std430, binding = " << binding << ") readonly buffer gltb_buffer" << binding
+        << " { uint gltb_data" << binding << "[]; }; \n"
+        << "uint gltb_u32_" << binding << "(uint b) { return gltb_data" << binding << "[b >> 2u]; } \n"
+        << "uint gltb_u16_" << binding << "(uint b) { return (gltb_u32_" << binding << "(b) >> ((b & 2u) * 8u)) & 0xffffu; } \n"
+        << "uint gltb_u8_" << binding << "(uint b) { return (gltb_u32_" << binding << "(b) >> ((b & 3u) * 8u)) & 0xffu; } \n";
+  };
+
+  for (const auto &stream : mStreams)
+  {
+    declare(stream.binding);
+    for (const auto &attribute : stream.layout.attributes())
+      src << fetch_function(stream, attribute);
+  }
+
+  // vertex of the current invocation
+  if (mIndices)
+  {
+    declare(mIndexBinding);
+
+    GLsizei size = VertexLayout::attribute_size(1, mIndexType);
+    src << "uint gltb_vertex() { return gltb_u" << 8 * size << "_" << mIndexBinding
+        << "(uint(gl_VertexID) * " << size << "u) + uint(gl_BaseInstanceARB); } \n";
+  }
+  else
+    src << "uint gltb_vertex() { return uint(gl_VertexID) + uint(gl_BaseInstanceARB); } \n";
+
+  return src.str();
+}
+
+std::string VertexPuller::fetch_function(const Stream &stream, const VertexLayout::Attribute &attribute)
+{
+  const GLuint b = stream.binding;
+  const GLsizei component = (attribute.type == GL_INT_2_10_10_10_REV || attribute.type == GL_UNSIGNED_INT_2_10_10_10_REV)
+                                ? 0
+                                : VertexLayout::attribute_size(1, attribute.type);
+
+  // glsl type of the result
+  std::string scalar = "float", vector = "vec";
+  if (attribute.integer)
+  {
+    bool isunsigned = (attribute.type == GL_UNSIGNED_INT || attribute.type == GL_UNSIGNED_SHORT || attribute.type == GL_UNSIGNED_BYTE);
+    scalar = isunsigned ? "uint" : "int";
+    vector = isunsigned ? "uvec" : "ivec";
+  }
+  std::string result = (attribute.size == 1) ? scalar : vector + std::to_string(attribute.size);
+
+  // expression reading component i starting at byte address a
+  auto read = [&](GLint i) {
+    std::ostringstream a;
+    a << "a + " << i * component << "u";
+
+    std::ostringstream e;
+    switch (attribute.type)
+    {
+    case GL_FLOAT:
+      e << "uintBitsToFloat(gltb_u32_" << b << "(" << a.str() << "))";
+      break;
+    case GL_HALF_FLOAT:
+      e << "unpackHalf2x16(gltb_u16_" << b << "(" << a.str() << ")).x";
+      break;
+    case GL_INT:
+      e << "int(gltb_u32_" << b << "(" << a.str() << "))";
+      break;
+    case GL_UNSIGNED_INT:
+      e << "gltb_u32_" << b << "(" << a.str() << ")";
+      break;
+    case GL_SHORT:
+      e << "(int(gltb_u16_" << b << "(" << a.str() << ") << 16u) >> 16)";
+      if (attribute.normalized && !attribute.integer)
+        e.str("max(float" + e.str() + " / 32767.0, -1.0)");
+      break;
+    case GL_UNSIGNED_SHORT:
+      e << "gltb_u16_" << b << "(" << a.str() << ")";
+      if (attribute.normalized && !attribute.integer)
+        e << " / 65535.0";
+      break;
+    case GL_BYTE:
+      e << "(int(gltb_u8_" << b << "(" << a.str() << ") << 24u) >> 24)";
+      if (attribute.normalized && !attribute.integer)
+        e.str("max(float" + e.str() + " / 127.0, -1.0)");
+      break;
+    case GL_UNSIGNED_BYTE:
+      e << "gltb_u8_" << b << "(" << a.str() << ")";
+      if (attribute.normalized && !attribute.integer)
+        e << " / 255.0";
+      break;
+    case GL_INT_2_10_10_10_REV:
+    {
+      GLint bits = (i == 3) ? 2 : 10;
+      e << "(int(gltb_u32_" << b << "(a) << " << 32 - bits - 10 * i << "u) >> " << 32 - bits << ")";
+      if (attribute.normalized)
+        e.str("max(float" + e.str() + " / " + ((i == 3) ? "1.0" : "511.0") + ", -1.0)");
+      break;
+    }
+    case GL_UNSIGNED_INT_2_10_10_10_REV:
+    {
+      GLint bits = (i == 3) ? 2 : 10;
+      e << "((gltb_u32_" << b << "(a) >> " << 10 * i << "u) & " << (1 << bits) - 1 << "u)";
+      if (attribute.normalized)
+        e << " / " << ((i == 3) ? "3.0" : "1023.0");
+      break;
+    }
+    default: // rejected by add_stream
+      break;
+    }
+
+    // conversion to the component type of the result
+    return scalar + "(" + e.str() + ")";
+  };
+
+  std::ostringstream src;
+  src << result << " fetch_" << attribute.name << "(uint v) { uint a = v * " << stream.layout.stride() << "u + "
+      << attribute.offset << "u; return " << result << "(";
+  for (GLint i = 0; i < attribute.size; ++i)
+    src << (i > 0 ? ", " : "") << read(i);
+  src << "); } \n";
+
+  return src.str();
+}
+
+void VertexPuller::bind() const
+{
+  mVao.bind();
+
+  // buffer names can change (growth, defragmentation), bind them at every draw
+  for (const auto &stream : mStreams)
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, stream.binding, stream.buffer->id());
+
+  if (mIndices)
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, mIndexBinding, mIndices->id());
+}
+
+void VertexPuller::draw(GLenum mode, GLuint first, GLsizei count, GLint basevertex) const
+{
+  glDrawArraysInstancedBaseInstance(mode, GLint(first), count, 1, GLuint(basevertex));
+}
+
+void VertexPuller::multi_draw_indirect(GLenum mode, const Buffer &commands, GLsizei drawcount, GLsizei first) const
+{
+  mVao.multi_draw_arrays_indirect(mode, commands, drawcount, first);
+}